@@ -0,0 +1,88 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* Allocator START                                      /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "allocator.h"
+
+void* allocator_allocate(const struct Allocator* allocator, size_t size) {
+  if (allocator == NULL) {
+    return malloc(size);
+  }
+  return allocator->allocate(allocator->context, size);
+}
+
+void* allocator_reallocate(
+  const struct Allocator* allocator,
+  void* pointer,
+  size_t old_size,
+  size_t new_size
+) {
+  if (new_size == 0) {
+    allocator_deallocate(allocator, pointer, old_size);
+    return NULL;
+  }
+  if (allocator == NULL) {
+    return realloc(pointer, new_size);
+  }
+  if (allocator->reallocate != NULL) {
+    return allocator->reallocate(
+      allocator->context,
+      pointer,
+      old_size,
+      new_size
+    );
+  }
+  
+  var new_pointer = allocator->allocate(allocator->context, new_size);
+  if (new_pointer == NULL) {
+    return NULL;
+  }
+  if (pointer != NULL) {
+    memcpy(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+    allocator_deallocate(allocator, pointer, old_size);
+  }
+  return new_pointer;
+}
+
+void allocator_deallocate(
+  const struct Allocator* allocator,
+  void* pointer,
+  size_t size
+) {
+  if (pointer == NULL) {
+    return;
+  }
+  if (allocator == NULL) {
+    free(pointer);
+  } else if (allocator->deallocate != NULL) {
+    allocator->deallocate(allocator->context, pointer, size);
+  }
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* Allocator END                       /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
@@ -0,0 +1,82 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef allocator_h
+#define allocator_h
+
+#include "types.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <stddef.h> /* For size_t */
+
+/**
+ * A source of memory for the collections.
+ *
+ * Every collection that takes an allocator at init time gets all of its
+ * storage, including the collection structure itself, from that allocator and
+ * returns it there. Passing NULL selects the system allocator (`malloc()`,
+ * `realloc()` and `free()`).
+ *
+ * The sizes of the blocks are passed back to `reallocate` and `deallocate`, so
+ * arenas and pools don't need to keep their own headers. The allocator must
+ * outlive every collection created with it.
+ */
+struct Allocator {
+  /* Returns a block of at least `size` bytes, or NULL on failure. */
+  void* (*allocate)(void* context, size_t size);
+  
+  /*
+   * Resizes a block previously returned by this allocator, moving it if
+   * necessary. `pointer` may be NULL, in which case `old_size` is 0. May be
+   * NULL, in which case the block is moved with `allocate` + `deallocate`.
+   */
+  void* (*reallocate)(
+    void* context,
+    void* pointer,
+    size_t old_size,
+    size_t new_size
+  );
+  
+  /*
+   * Returns a block to this allocator. May be NULL, e.g. for arenas that are
+   * released in one go.
+   */
+  void (*deallocate)(void* context, void* pointer, size_t size);
+  
+  /* An opaque pointer passed to every function above. */
+  void* context;
+};
+
+/*----------------------------------------------------------------------------*/
+/* Allocates `size` bytes from `allocator`, or from `malloc()` if it's NULL. */
+void* allocator_allocate(const struct Allocator* allocator, size_t size);
+
+/*
+ * Resizes a block allocated from `allocator`. Resizing to 0 bytes frees the
+ * block and returns NULL.
+ */
+void* allocator_reallocate(
+  const struct Allocator* allocator,
+  void* pointer,
+  size_t old_size,
+  size_t new_size
+);
+
+/* Frees a block allocated from `allocator`. NULL pointers are ignored. */
+void allocator_deallocate(
+  const struct Allocator* allocator,
+  void* pointer,
+  size_t size
+);
+/*----------------------------------------------------------------------------*/
+
+#endif /* allocator_h */
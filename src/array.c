@@ -18,8 +18,32 @@
  * information
  */
 
+#ifdef __linux__
+#define _GNU_SOURCE /* For mremap() */
+#endif
+
 #include "array.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define _ARRAY_VECTOR_BYTES 32
+#define _array_vector_load(p) _mm256_loadu_si256((const __m256i*)(p))
+#define _array_vector_equal_mask(a, b)                                        \
+  ((UInt64)(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8((a), (b))))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define _ARRAY_VECTOR_BYTES 16
+#define _array_vector_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define _array_vector_equal_mask(a, b)                                        \
+  ((UInt64)(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8((a), (b))))
+#endif
+
 /*
  * Error code of Array:
  * 0: NO ERROR
@@ -30,20 +54,58 @@
  * 6: Can't remove last element from an empty collection
  */
 
-static void _array_init(struct Array* array, Int64 count, UInt32 width) {
-  /* Rounding up to next power of 2 */
-  var capacity = count - 1;
+/*
+ * Rounds `count` up to the next power of 2.
+ *
+ * The shifts cover all 64 bits, so the result is also correct for counts above
+ * 2^32. `count` must be positive.
+ */
+static Int64 _array_round_up_capacity(Int64 count) {
+  var capacity = (UInt64)count - 1;
   capacity |= capacity >> 1;
   capacity |= capacity >> 2;
   capacity |= capacity >> 4;
   capacity |= capacity >> 8;
   capacity |= capacity >> 16;
+  capacity |= capacity >> 32;
   capacity += 1;
-  
-  if (count == 0) {
-    array->_storage = NULL;
+  return (Int64)capacity;
+}
+
+/*
+ * The offset of the inline storage from the start of an Array, rounded up so
+ * that inline elements are aligned like `malloc()`ed ones.
+ */
+#define _ARRAY_INLINE_OFFSET ((sizeof(struct Array) + 15) & ~(size_t)15)
+
+/* Returns the inline storage of the array, or NULL if it doesn't have one. */
+static void* _array_inline_storage(struct Array* array) {
+  if (array->_inline_capacity == 0) {
+    return NULL;
+  }
+  return (UInt8*)array + _ARRAY_INLINE_OFFSET;
+}
+
+/* Returns true if the elements currently live inside the Array structure. */
+static Bool _array_is_inline(struct Array* array) {
+  return array->_inline_capacity > 0 &&
+         array->_storage == _array_inline_storage(array);
+}
+
+static void _array_init(
+  struct Array* array,
+  Int64 capacity,
+  UInt32 width,
+  Int64 inline_capacity,
+  const struct Allocator* allocator
+) {
+  array->_allocator = allocator;
+  array->_inline_capacity = inline_capacity;
+  if (capacity <= inline_capacity) {
+    array->_storage = _array_inline_storage(array);
+    capacity = inline_capacity;
   } else {
-    array->_storage = malloc(capacity * width);
+    array->_storage = allocator_allocate(allocator, capacity * width);
     if (array->_storage == NULL) {
       fprintf(stderr, ARRAY_FATAL_ERR_MALLOC);
       abort();
@@ -51,8 +113,16 @@ static void _array_init(struct Array* array, Int64 count, UInt32 width) {
   }
   array->_width = width;
   array->_capacity = capacity;
-  array->count = count;
-  array->is_empty = count == 0 ? true : false;
+  array->count = 0;
+  array->is_empty = true;
+  array->_shrink_policy = ARRAY_SHRINK_POLICY_HALVE;
+  array->_keeps_capacity = false;
+  array->_mapping_threshold = 0;
+  array->_is_mapped = false;
+  array->_mapped_size = 0;
+  array->_uses_huge_pages = false;
+  array->_is_read_only = false;
+  array->_reference_count = NULL;
 }
 
 /* Check that the specified `index` is valid, i.e. `0 ≤ index < count`. */
@@ -63,29 +133,466 @@ static void _array_check_index(struct Array* array, Int64 index) {
   }
 }
 
-/* MARK: - Creating and Destroying an Array */
+/*
+ * Frees `storage`, the current out-of-line storage of the array, whether it
+ * comes from the allocator or from `mmap()`.
+ */
+static void _array_deallocate(struct Array* array, void* storage) {
+  if (array->_is_mapped) {
+    /* File mappings start with the header, right before the elements. */
+    if (array->_is_read_only) {
+      storage -= ARRAY_FILE_HEADER_SIZE;
+    }
+    munmap(storage, array->_mapped_size);
+    array->_is_mapped = false;
+    array->_is_read_only = false;
+    array->_mapped_size = 0;
+    return;
+  }
+  allocator_deallocate(
+    array->_allocator,
+    storage,
+    array->_capacity * array->_width
+  );
+}
 
-struct Array* array_init(UInt32 width) {
+#ifdef __linux__
+/*
+ * Moves the storage to (or resizes it within) an anonymous memory mapping of at
+ * least `new_size` bytes.
+ *
+ * Growing a mapping with `mremap()` only rewrites page tables, so unlike
+ * `realloc()` it never copies the elements, and it doesn't need the old and
+ * the new block to be alive at the same time.
+ */
+static void _array_map(struct Array* array, Int64 new_size) {
+  var page_size = (Int64)sysconf(_SC_PAGESIZE);
+  var size = (new_size + page_size - 1) / page_size * page_size;
+  void* storage;
+  if (array->_is_mapped) {
+    storage = mremap(
+      array->_storage,
+      array->_mapped_size,
+      size,
+      MREMAP_MAYMOVE
+    );
+  } else {
+    storage = mmap(
+      NULL,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0
+    );
+  }
+  if (storage == MAP_FAILED) {
+    fprintf(stderr, ARRAY_FATAL_ERR_MMAP);
+    abort();
+  }
+#ifdef MADV_HUGEPAGE
+  if (array->_uses_huge_pages) {
+    madvise(storage, size, MADV_HUGEPAGE);
+  }
+#endif
+  if (!array->_is_mapped) { /* heap or inline -> mapping */
+    if (array->count > 0) {
+      memcpy(storage, array->_storage, array->count * array->_width);
+    }
+    if (!_array_is_inline(array)) {
+      _array_deallocate(array, array->_storage);
+    }
+  }
+  array->_storage = storage;
+  array->_is_mapped = true;
+  array->_mapped_size = size;
+  array->_capacity = size / array->_width;
+}
+#endif
+
+/* MARK: - Copy-on-Write */
+
+/*
+ * Drops one reference to shared storage, freeing the storage and its reference
+ * count if it was the last one. The array no longer owns any storage after.
+ */
+static void _array_release_reference(struct Array* array) {
+  var count = __atomic_sub_fetch(array->_reference_count, 1, __ATOMIC_ACQ_REL);
+  if (count == 0) {
+    allocator_deallocate(
+      array->_allocator,
+      array->_reference_count,
+      sizeof(Int64)
+    );
+    _array_deallocate(array, array->_storage);
+  }
+  array->_reference_count = NULL;
+  array->_is_mapped = false;
+  array->_mapped_size = 0;
+}
+
+/*
+ * Returns true if a snapshot shares the storage of the array, or if it is a
+ * read-only file mapping.
+ *
+ * Once every snapshot has been destroyed the count is back to 1, and it is
+ * dropped here, so the storage is owned outright again without a copy. No
+ * other array holds a reference at that point, so nothing can race with it.
+ */
+static Bool _array_is_shared(struct Array* array) {
+  if (array->_is_read_only) {
+    return true;
+  }
+  if (array->_reference_count == NULL) {
+    return false;
+  }
+  if (__atomic_load_n(array->_reference_count, __ATOMIC_ACQUIRE) > 1) {
+    return true;
+  }
+  allocator_deallocate(
+    array->_allocator,
+    array->_reference_count,
+    sizeof(Int64)
+  );
+  array->_reference_count = NULL;
+  return false;
+}
+
+static void _array_reallocate(struct Array* array, Int64 capacity);
+
+/*
+ * Gives the array a private copy of its shared storage, with room for
+ * `capacity` elements, which must be at least the count.
+ *
+ * Growing or shrinking shared storage goes straight here, so the elements are
+ * copied once rather than copied and then reallocated.
+ */
+static void _array_unshare(struct Array* array, Int64 capacity) {
+  var shared = *array;
+  var count = array->count;
+  array->_reference_count = NULL;
+  array->_is_mapped = false;
+  array->_is_read_only = false;
+  array->_mapped_size = 0;
+  if (array->_inline_capacity > 0 && capacity <= array->_inline_capacity) {
+    array->_storage = _array_inline_storage(array);
+    array->_capacity = array->_inline_capacity;
+  } else {
+    /* Allocate as if from empty, so nothing is copied or freed yet. */
+    array->_storage = NULL;
+    array->_capacity = 0;
+    array->count = 0;
+    _array_reallocate(array, capacity);
+    array->count = count;
+  }
+  if (count > 0) {
+    memcpy(array->_storage, shared._storage, count * array->_width);
+  }
+  if (shared._reference_count != NULL) {
+    _array_release_reference(&shared);
+  } else { /* an unshared file mapping */
+    _array_deallocate(&shared, shared._storage);
+  }
+}
+
+/* Copies the storage if a snapshot shares it, before it is written to. */
+static void _array_make_unique(struct Array* array) {
+  if (_array_is_shared(array)) {
+    _array_unshare(array, array->_capacity);
+  }
+}
+
+/* MARK: - Storage */
+
+/*
+ * Resizes the storage to hold exactly `capacity` elements.
+ *
+ * Arrays with inline storage move their elements out of the Array structure
+ * when `capacity` exceeds the inline capacity, and back into it when it
+ * doesn't. The capacity never drops below the inline capacity.
+ *
+ * Arrays with a mapping threshold move their elements into an anonymous
+ * mapping once the storage reaches the threshold, and back to the allocator
+ * when it drops below it. Mapped capacities are rounded up to whole pages.
+ */
+static void _array_reallocate(struct Array* array, Int64 capacity) {
+  if (_array_is_shared(array)) {
+    _array_unshare(array, capacity);
+    return;
+  }
+  var width = array->_width;
+  if (array->_inline_capacity > 0 && capacity <= array->_inline_capacity) {
+    if (!_array_is_inline(array)) { /* heap -> inline */
+      var storage = array->_storage;
+      array->_storage = _array_inline_storage(array);
+      memcpy(array->_storage, storage, array->count * width);
+      _array_deallocate(array, storage);
+    }
+    array->_capacity = array->_inline_capacity;
+    return;
+  }
+  var new_size = capacity * width;
+#ifdef __linux__
+  var threshold = array->_mapping_threshold;
+  if (threshold > 0 && new_size >= threshold) {
+    _array_map(array, new_size);
+    return;
+  }
+  if (array->_is_mapped) { /* mapping -> heap */
+    void* storage = NULL;
+    if (new_size > 0) {
+      storage = allocator_allocate(array->_allocator, new_size);
+      if (storage == NULL) {
+        fprintf(stderr, ARRAY_FATAL_ERR_MALLOC);
+        abort();
+      }
+      memcpy(storage, array->_storage, array->count * width);
+    }
+    _array_deallocate(array, array->_storage);
+    array->_storage = storage;
+    array->_capacity = capacity;
+    return;
+  }
+#endif
+  if (_array_is_inline(array)) { /* inline -> heap */
+    var storage = allocator_allocate(array->_allocator, new_size);
+    if (storage == NULL) {
+      fprintf(stderr, ARRAY_FATAL_ERR_MALLOC);
+      abort();
+    }
+    memcpy(storage, array->_storage, array->count * width);
+    array->_storage = storage;
+    array->_capacity = capacity;
+    return;
+  }
+  array->_storage = allocator_reallocate(
+    array->_allocator,
+    array->_storage,
+    array->_capacity * array->_width,
+    new_size
+  );
+  if (array->_storage == NULL && new_size != 0) { /* Linux fix */
+    fprintf(stderr, ARRAY_FATAL_ERR_REALLO);
+    abort();
+  }
+  array->_capacity = capacity;
+}
+
+/*
+ * Makes sure the array can hold at least `minimum_capacity` elements.
+ *
+ * The new capacity is computed once, so a batch of n elements costs at most
+ * one reallocation instead of log(n).
+ */
+static void _array_grow(struct Array* array, Int64 minimum_capacity) {
+  if (minimum_capacity <= array->_capacity) {
+    return;
+  }
+  var capacity = _array_round_up_capacity(minimum_capacity);
+  if (capacity < array->_capacity * ARRAY_MULTIPLE_FACTOR) {
+    capacity = array->_capacity * ARRAY_MULTIPLE_FACTOR;
+  }
+  _array_reallocate(array, capacity);
+}
+
+/*
+ * Releases part of the storage after elements have been removed, according to
+ * the shrink policy of the array.
+ */
+static void _array_shrink(struct Array* array) {
+  var factor = ARRAY_RESIZE_FACTOR;
+  switch (array->_shrink_policy) {
+    case ARRAY_SHRINK_POLICY_NEVER:
+      return;
+    case ARRAY_SHRINK_POLICY_HYSTERESIS:
+      factor = ARRAY_HYSTERESIS_FACTOR;
+      break;
+    case ARRAY_SHRINK_POLICY_HALVE:
+    default:
+      break;
+  }
+  /*
+   * Halve as many times as a sequence of single removals would have, so that
+   * removing a whole range still costs a single reallocation.
+   */
+  var capacity = array->_capacity;
+  while (capacity > 0 && array->count * factor <= capacity) {
+    capacity /= ARRAY_MULTIPLE_FACTOR;
+  }
+  if (capacity != array->_capacity) {
+    _array_reallocate(array, capacity);
+  }
+}
+
+/*
+ * Frees the heap storage of the array, if any, or drops its reference to
+ * storage shared with snapshots.
+ */
+static void _array_release_storage(struct Array* array) {
+  if (array->_reference_count != NULL) {
+    _array_release_reference(array);
+  } else if (!_array_is_inline(array)) {
+    _array_deallocate(array, array->_storage);
+  }
+  array->_storage = _array_inline_storage(array);
+  array->_capacity = array->_inline_capacity;
+}
+
+/* Returns the number of bytes of an Array structure with inline storage. */
+static size_t _array_size(Int64 inline_capacity, UInt32 width) {
+  if (inline_capacity == 0) {
+    return sizeof(struct Array);
+  }
+  return _ARRAY_INLINE_OFFSET + inline_capacity * width;
+}
+
+static struct Array* _array_create(
+  UInt32 width,
+  Int64 capacity,
+  Int64 inline_capacity,
+  const struct Allocator* allocator
+) {
   struct Array* array;
-  if ((array = malloc(sizeof(struct Array))) == NULL) {
+  inline_capacity = inline_capacity < 0 ? 0 : inline_capacity;
+  var size = _array_size(inline_capacity, width);
+  if ((array = allocator_allocate(allocator, size)) == NULL) {
     return NULL;
   }
-  _array_init(array, 0, width);
+  capacity = capacity < 0 ? 0 : capacity;
+  _array_init(array, capacity, width, inline_capacity, allocator);
   return array;
 }
 
+/* MARK: - Creating and Destroying an Array */
+
+struct Array* array_init(UInt32 width) {
+  return _array_create(width, 0, 0, NULL);
+}
+
+struct Array* array_init_with_capacity(UInt32 width, Int64 capacity) {
+  return _array_create(width, capacity, 0, NULL);
+}
+
+struct Array* array_init_with_inline_capacity(
+  UInt32 width,
+  Int64 inline_capacity
+) {
+  return _array_create(width, 0, inline_capacity, NULL);
+}
+
+struct Array* array_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+) {
+  return _array_create(width, 0, 0, allocator);
+}
+
 void array_deinit(struct Array* array) {
   if (array == NULL) {
     return;
   }
   
-  free(array->_storage);
+  var allocator = array->_allocator;
+  var size = _array_size(array->_inline_capacity, array->_width);
+  _array_release_storage(array);
   array->count = 0;
   array->_width = 0;
   array->_capacity = 0;
   array->is_empty = true;
   
-  free(array);
+  allocator_deallocate(allocator, array, size);
+}
+
+struct Array* array_snapshot(struct Array* array) {
+  var width = array->_width;
+  var count = array->count;
+  if (array->_storage == NULL || _array_is_inline(array)) {
+    /* Nothing to share: copy the few inline elements, if any. */
+    var copy = _array_create(
+      width,
+      count,
+      array->_inline_capacity,
+      array->_allocator
+    );
+    if (copy == NULL) {
+      return NULL;
+    }
+    if (count > 0) {
+      memcpy(copy->_storage, array->_storage, count * width);
+    }
+    copy->count = count;
+    copy->is_empty = array->is_empty;
+    copy->_shrink_policy = array->_shrink_policy;
+    copy->_keeps_capacity = array->_keeps_capacity;
+    copy->_mapping_threshold = array->_mapping_threshold;
+    copy->_uses_huge_pages = array->_uses_huge_pages;
+    return copy;
+  }
+  
+  var snapshot = _array_create(width, 0, 0, array->_allocator);
+  if (snapshot == NULL) {
+    return NULL;
+  }
+  if (array->_reference_count == NULL) {
+    array->_reference_count = allocator_allocate(
+      array->_allocator,
+      sizeof(Int64)
+    );
+    if (array->_reference_count == NULL) {
+      array_deinit(snapshot);
+      return NULL;
+    }
+    *array->_reference_count = 1;
+  }
+  __atomic_add_fetch(array->_reference_count, 1, __ATOMIC_RELAXED);
+  
+  snapshot->_storage = array->_storage;
+  snapshot->_capacity = array->_capacity;
+  snapshot->count = count;
+  snapshot->is_empty = array->is_empty;
+  snapshot->_shrink_policy = array->_shrink_policy;
+  snapshot->_keeps_capacity = array->_keeps_capacity;
+  snapshot->_mapping_threshold = array->_mapping_threshold;
+  snapshot->_uses_huge_pages = array->_uses_huge_pages;
+  snapshot->_is_mapped = array->_is_mapped;
+  snapshot->_is_read_only = array->_is_read_only;
+  snapshot->_mapped_size = array->_mapped_size;
+  snapshot->_reference_count = array->_reference_count;
+  return snapshot;
+}
+
+/* MARK: - Managing Capacity */
+
+void array_reserve(struct Array* array, Int64 minimum_capacity) {
+  if (minimum_capacity <= array->_capacity) {
+    return;
+  }
+  _array_reallocate(array, minimum_capacity);
+}
+
+void array_shrink_to_fit(struct Array* array) {
+  if (array->count == array->_capacity) {
+    return;
+  }
+  _array_reallocate(array, array->count);
+}
+
+void array_set_shrink_policy(
+  struct Array* array,
+  enum ArrayShrinkPolicy policy,
+  Bool keeps_capacity
+) {
+  array->_shrink_policy = policy;
+  array->_keeps_capacity = keeps_capacity;
+}
+
+void array_set_mapping_threshold(
+  struct Array* array,
+  Int64 threshold,
+  Bool uses_huge_pages
+) {
+  array->_mapping_threshold = threshold < 0 ? 0 : threshold;
+  array->_uses_huge_pages = uses_huge_pages;
 }
 
 /* MARK: - Accessing Elements */
@@ -101,9 +608,25 @@ void array_get(struct Array* array, Int64 index, void* element) {
   );
 }
 
+void* array_at(struct Array* array, Int64 index) {
+  _array_check_index(array, index);
+  _array_make_unique(array);
+  
+  return array->_storage + array->_width * index;
+}
+
+void* array_span(struct Array* array, Int64* count) {
+  _array_make_unique(array);
+  if (count != NULL) {
+    *count = array->count;
+  }
+  return array->_storage;
+}
+
 /* Replaces the element at the specified position. */
 void array_set(struct Array* array, Int64 index, void* element) {
   _array_check_index(array, index);
+  _array_make_unique(array);
 
   memcpy(
     array->_storage + array->_width * index,
@@ -115,19 +638,8 @@ void array_set(struct Array* array, Int64 index, void* element) {
 /* MARK: - Adding Elements */
 
 void array_append(struct Array* array, void* new_element) {
-  if (array->_capacity == 0) {
-    array->_storage = realloc(array->_storage, 1 * array->_width);
-    array->_capacity = 1;
-  }
-  if (array->count == array->_capacity) {
-    array->_capacity *= ARRAY_MULTIPLE_FACTOR;
-    var new_size = array->_capacity * array->_width;
-    array->_storage = realloc(array->_storage, new_size);
-    if (array->_storage == NULL) {
-      fprintf(stderr, ARRAY_FATAL_ERR_REALLO);
-      abort();
-    }
-  }
+  _array_grow(array, array->count + 1);
+  _array_make_unique(array);
   array->count += 1;
   array->is_empty = false;
   memcpy(
@@ -137,49 +649,33 @@ void array_append(struct Array* array, void* new_element) {
   );
 }
 
-///* 
-// * Inserts a new element at the specified position.
-// *
-// * - Complexity:
-// *   O(n), where n is the length of the array.
-// */
-//int array_insert(struct Array* array, void* element, int i) {
-//  if (i == array->count) { /* this method is equivalent to append(_:) */
-//    return array_append(array, element);
-//  }
-//  var err = _check_index(array, i);
-//  if (err != 0) {
-//    return err;
-//  }
-//  /* Dumb append to make room for the new element. Update is_empty & count. */
-//  if ((err = array_append(array, element)) != 0) {
-//    return err;
-//  }
-//  /*
-//   * [1, 2, 3, 4, 5]  <----- insert(100, at: 3)
-//   *
-//   *  0  1  2  3  4    5
-//   * [1, 2, 3, 4, 5, 100]  <---- after append, count = 6
-//   *           \--/  <---- shift right by one (i ..< count - 1)
-//   *                                          (move length = count - 1 - i)
-//   *
-//   * Then copy new_element at index 3.
-//   *
-//   *    0  1  2    3  4  5
-//   * = [1, 2, 3, 100, 4, 5]
-//   */
-//  memmove(
-//    array->_storage + (i + 1) * array->_width,
-//    array->_storage + i * array->_width,
-//    (array->count - 1 - i) * array->_width
-//  );
-//  memcpy(
-//    array->_storage + i * array->_width,
-//    element,
-//    array->_width
-//  );
-//  return err;
-//}
+void array_append_contents(struct Array* array, const void* base, Int64 n) {
+  if (n <= 0) {
+    return;
+  }
+  _array_grow(array, array->count + n);
+  _array_make_unique(array);
+  memcpy(
+    array->_storage + array->count * array->_width,
+    base,
+    n * array->_width
+  );
+  array->count += n;
+  array->is_empty = false;
+}
+
+void array_insert(struct Array* array, Int64 index, void* new_element) {
+  array_replace_subrange(array, index, index, new_element, 1);
+}
+
+void array_insert_contents(
+  struct Array* array,
+  Int64 index,
+  const void* base,
+  Int64 n
+) {
+  array_replace_subrange(array, index, index, base, n);
+}
 
 /* MARK: - Removing Elements */
 
@@ -192,104 +688,231 @@ void array_remove_last(struct Array* array) {
   if (array->count == 0) {
     array->is_empty = true;
   }
-  if (array->count * ARRAY_RESIZE_FACTOR <= array->_capacity) {
-    array->_capacity /= ARRAY_MULTIPLE_FACTOR;
-    var new_size = array->_capacity * array->_width;
-    array->_storage = realloc(array->_storage, new_size);
-    if (array->_storage == NULL && new_size != 0) { /* Linux fix */
-      fprintf(stderr, ARRAY_FATAL_ERR_REALLO);
-      abort();
-    }
-  }
+  _array_shrink(array);
 }
 
-///* 
-// * Removes the element at the specified position.
-// *
-// * - Complexity:
-// *   O(n), where n is the length of the array.
-// */
-//int array_remove_at(struct Array* array, int i) {
-//  var err = 0;
-//  if ((err = _check_index(array, i)) != 0) {
-//    return err;
-//  }
-//
-//  if (i == array->count - 1) {
-//    return array_remove_last(array);
-//  }
-//
-//  /*
-//   *    0    1    2    3    4    5    6
-//   * [1.1, 1.5, 2.9, 1.2, 1.5, 1.3, 1.2]   <---  remove(at: 2)
-//   *                 \----------------/  <---  shift left by one (i+1 ..< count)
-//   *                                     <--- move length = count - i - 1
-//   * [1.1, 1.5, 1.2, 1.5, 1.3, 1.2, 1.2]
-//   *
-//   * then, call remove_last()
-//   *
-//   * [1.1, 1.5, 1.2, 1.5, 1.3, 1.2]
-//   */
-//  memmove(
-//    array->_storage + i * array->width,
-//    array->_storage + (i + 1) * array->width,
-//    (array->count - i - 1) * array->width
-//  );
-//  return array_remove_last(array);
-//}
+void array_remove_at(struct Array* array, Int64 index) {
+  _array_check_index(array, index);
+  array_replace_subrange(array, index, index + 1, NULL, 0);
+}
+
+void array_remove_subrange(struct Array* array, Int64 start, Int64 end) {
+  array_replace_subrange(array, start, end, NULL, 0);
+}
 
 void array_remove_all(struct Array* array) {
-  free(array->_storage);
-  array->_storage = NULL;
   array->count = 0;
-  array->_capacity = 0;
   array->is_empty = true;
+  if (array->_keeps_capacity) {
+    return;
+  }
+  _array_release_storage(array);
+}
+
+void array_remove_all_where(
+  struct Array* array,
+  Bool (*should_be_removed)(const void* element, void* context),
+  void* context
+) {
+  _array_make_unique(array);
+  var width = array->_width;
+  var count = array->count;
+  var storage = (UInt8*)array->_storage;
+  
+  /*
+   * [1, 2, x, x, 3, 4, 5, x, 6]  <---- remove all x
+   *              \-----/
+   *                run
+   *
+   * Each run of survivors is moved down with a single memmove() when the next
+   * removed element (or the end) is reached.
+   */
+  var new_count = 0ll;
+  var run_start = 0ll;
+  var i = 0ll;
+  for (i = 0; i <= count; i += 1) {
+    if (i < count && !should_be_removed(storage + i * width, context)) {
+      continue;
+    }
+    if (i > run_start && new_count != run_start) {
+      memmove(
+        storage + new_count * width,
+        storage + run_start * width,
+        (i - run_start) * width
+      );
+    }
+    new_count += i - run_start;
+    run_start = i + 1;
+  }
+  
+  if (new_count == count) {
+    return;
+  }
+  array->count = new_count;
+  array->is_empty = new_count == 0;
+  _array_shrink(array);
+}
+
+/* MARK: - Replacing Elements */
+
+void array_replace_subrange(
+  struct Array* array,
+  Int64 start,
+  Int64 end,
+  const void* base,
+  Int64 n
+) {
+  if (start < 0 || end > array->count || start > end || n < 0) {
+    fprintf(stderr, ARRAY_FATAL_ERR_OUTOB);
+    abort();
+  }
+  /*
+   *    0  1  2  3  4  5  6
+   *   [1, 2, 3, 4, 5, 6, 7]  <----- replace 2 ..< 4 with [8, 9, 10]
+   *          \--/  \-----/
+   *     subrange   tail (end ..< count), shifted once by n - (end - start)
+   *
+   *   [1, 2, 8, 9, 10, 5, 6, 7]
+   */
+  var width = array->_width;
+  var new_count = array->count - (end - start) + n;
+  _array_grow(array, new_count);
+  _array_make_unique(array);
+  if (n != end - start) {
+    memmove(
+      array->_storage + (start + n) * width,
+      array->_storage + end * width,
+      (array->count - end) * width
+    );
+  }
+  if (n > 0) {
+    memcpy(array->_storage + start * width, base, n * width);
+  }
+  array->count = new_count;
+  array->is_empty = new_count == 0;
+  _array_shrink(array);
 }
 
 /* MARK: - Finding Elements */
 
+#ifdef _ARRAY_VECTOR_BYTES
 /*
- * Returns a Boolean value indicating whether the sequence contains the given 
- * element.
+ * Keeps bit i of `mask` only if i is set in `lane_starts` and the bits
+ * i ..< i + width are all set, i.e. only the first byte of every element whose
+ * bytes all compared equal. `width` must be a power of 2.
  */
-//bool array_contains(
-//  struct Array* array,
-//  void* key,
-//  bool (*equal)(const void*, const void*)
-//) {
-//  var buf = malloc(array->width);
-//  var i = 0;
-//  for (i = 0; i < array->count; i += 1) {
-//    array_get(array, i, buf);
-//    if (equal(buf, key)) {
-//      free(buf);
-//      return true;
-//    }
-//  }
-//  free(buf);
-//  return false;
-//}
-//
-///*
-// * Returns the first index where the specified value appears in the collection.
-// */
-//int array_first_index(
-//  struct Array* array,
-//  void* key,
-//  bool (*equal)(const void*, const void*)
-//) {
-//  var buf = malloc(array->width);
-//  var i = 0;
-//  for (i = 0; i < array->count; i += 1) {
-//    array_get(array, i, buf);
-//    if (equal(buf, key)) {
-//      free(buf);
-//      return i;
-//    }
-//  }
-//  free(buf);
-//  return -1;
-//}
+static UInt64 _array_element_mask(
+  UInt64 mask,
+  UInt32 width,
+  UInt64 lane_starts
+) {
+  var shift = 1u;
+  for (shift = 1; shift < width; shift *= 2) {
+    mask &= mask >> shift;
+  }
+  return mask & lane_starts;
+}
+
+/*
+ * Searches with vector byte comparisons, for widths that divide the vector
+ * size (2, 4, 8 and 16 bytes).
+ *
+ * The key is repeated across a whole vector, each block of elements is
+ * compared byte by byte, and `_array_element_mask()` turns the byte mask into
+ * a mask of fully matching elements.
+ */
+static Int64 _array_vector_first_index(
+  const UInt8* storage,
+  Int64 count,
+  UInt32 width,
+  const void* key
+) {
+  UInt8 pattern[_ARRAY_VECTOR_BYTES];
+  var lane_starts = 0ull;
+  var b = 0u;
+  for (b = 0; b < _ARRAY_VECTOR_BYTES; b += width) {
+    memcpy(pattern + b, key, width);
+    lane_starts |= 1ull << b;
+  }
+  var needle = _array_vector_load(pattern);
+  var elements_per_vector = _ARRAY_VECTOR_BYTES / width;
+  
+  var i = 0ll;
+  for (; i + elements_per_vector <= count; i += elements_per_vector) {
+    var block = _array_vector_load(storage + i * width);
+    var mask = _array_vector_equal_mask(block, needle);
+    if (mask == 0) {
+      continue;
+    }
+    mask = _array_element_mask(mask, width, lane_starts);
+    if (mask != 0) {
+      return i + __builtin_ctzll(mask) / width;
+    }
+  }
+  for (; i < count; i += 1) {
+    if (memcmp(storage + i * width, key, width) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+#endif
+
+/* Scalar search with the element loaded as one integer. */
+#define _ARRAY_SCALAR_FIRST_INDEX(Type, storage, count, key)                  \
+  do {                                                                        \
+    Type __key;                                                               \
+    memcpy(&__key, (key), sizeof(Type));                                      \
+    var __i = 0ll;                                                            \
+    for (__i = 0; __i < (count); __i += 1) {                                  \
+      Type __element;                                                         \
+      memcpy(&__element, (storage) + __i * sizeof(Type), sizeof(Type));       \
+      if (__element == __key) {                                               \
+        return __i;                                                           \
+      }                                                                       \
+    }                                                                         \
+    return -1;                                                                \
+  } while (0)
+
+Int64 array_first_index_of_bytes(struct Array* array, const void* key) {
+  var storage = (const UInt8*)array->_storage;
+  var count = array->count;
+  var width = array->_width;
+  if (count == 0) {
+    return -1;
+  }
+  
+  if (width == 1) { /* libc's memchr() is already vectorized */
+    var match = (const UInt8*)memchr(storage, *(const UInt8*)key, count);
+    return match == NULL ? -1 : match - storage;
+  }
+#ifdef _ARRAY_VECTOR_BYTES
+  if (width == 2 || width == 4 || width == 8 || width == 16) {
+    return _array_vector_first_index(storage, count, width, key);
+  }
+#endif
+  switch (width) {
+    case 2:
+      _ARRAY_SCALAR_FIRST_INDEX(UInt16, storage, count, key);
+    case 4:
+      _ARRAY_SCALAR_FIRST_INDEX(UInt32, storage, count, key);
+    case 8:
+      _ARRAY_SCALAR_FIRST_INDEX(UInt64, storage, count, key);
+    default:
+      break;
+  }
+  var i = 0ll;
+  for (i = 0; i < count; i += 1) {
+    if (memcmp(storage + i * width, key, width) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Bool array_contains_bytes(struct Array* array, const void* key) {
+  return array_first_index_of_bytes(array, key) != -1;
+}
 
 /* MARK: - Reordering an Array’s Elements */
 
@@ -300,8 +923,145 @@ void array_sort(
   if (array->count <= 1) {
     return;
   }
+  _array_make_unique(array);
   sort(array->_storage, array->count, array->_width, compare);
 }
+
+void array_sort_parallel(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*),
+  Int64 thread_count
+) {
+  if (array->count <= 1) {
+    return;
+  }
+  _array_make_unique(array);
+  sort_parallel(
+    array->_storage,
+    array->count,
+    array->_width,
+    compare,
+    thread_count
+  );
+}
+
+void array_radix_sort(
+  struct Array* array,
+  size_t key_offset,
+  enum SortKeyType key_type
+) {
+  if (array->count <= 1) {
+    return;
+  }
+  _array_make_unique(array);
+  radix_sort(
+    array->_storage,
+    array->count,
+    array->_width,
+    key_offset,
+    key_type
+  );
+}
+
+void array_stable_sort(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*)
+) {
+  if (array->count <= 1) {
+    return;
+  }
+  _array_make_unique(array);
+  stable_sort(array->_storage, array->count, array->_width, compare, NULL, 0);
+}
+
+struct Array* array_argsort(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*)
+) {
+  var indices = _array_create(
+    sizeof(Int64),
+    array->count,
+    0,
+    array->_allocator
+  );
+  if (indices == NULL) {
+    return NULL;
+  }
+  sort_indices(
+    array->_storage,
+    array->count,
+    array->_width,
+    compare,
+    indices->_storage
+  );
+  indices->count = array->count;
+  indices->is_empty = array->count == 0;
+  return indices;
+}
+
+void array_apply_permutation(
+  struct Array* array,
+  struct Array* permutation
+) {
+  if (
+    permutation->count != array->count ||
+    permutation->_width != sizeof(Int64)
+  ) {
+    fprintf(stderr, ARRAY_FATAL_ERR_PERM);
+    abort();
+  }
+  if (array->count <= 1) {
+    /* The only permutation of one element is {0}. */
+    if (array->count == 1 && *(Int64*)permutation->_storage != 0) {
+      fprintf(stderr, ARRAY_FATAL_ERR_PERM);
+      abort();
+    }
+    return;
+  }
+  _array_make_unique(array);
+  _array_make_unique(permutation);
+  
+  var width = array->_width;
+  var storage = array->_storage;
+  Int64* indices = permutation->_storage;
+  var element = allocator_allocate(array->_allocator, width);
+  if (element == NULL) {
+    fprintf(stderr, ARRAY_FATAL_ERR_MALLOC);
+    abort();
+  }
+  
+  /*
+   * Visited entries are marked by flipping their bits, which makes them
+   * negative, so any index that is out of range or seen twice is caught.
+   */
+  var start = 0ll;
+  for (start = 0; start < array->count; start += 1) {
+    if (indices[start] < 0) {
+      continue;
+    }
+    memcpy(element, storage + start * width, width);
+    var i = start;
+    while (true) {
+      var source = indices[i];
+      if (source < 0 || source >= array->count) {
+        fprintf(stderr, ARRAY_FATAL_ERR_PERM);
+        abort();
+      }
+      indices[i] = ~source;
+      if (source == start) {
+        memcpy(storage + i * width, element, width);
+        break;
+      }
+      memcpy(storage + i * width, storage + source * width, width);
+      i = source;
+    }
+  }
+  
+  for (start = 0; start < array->count; start += 1) {
+    indices[start] = ~indices[start];
+  }
+  allocator_deallocate(array->_allocator, element, width);
+}
 //
 ///* Exchanges the values at the specified indices of the collection. */
 //int array_swap_at(struct Array* array, int i, int j) {
@@ -325,64 +1085,245 @@ void array_sort(
 
 /* MARK: - Comparing Arrays */
 
+Bool array_equal(struct Array* lhs, struct Array* rhs) {
+  if (lhs->count != rhs->count || lhs->_width != rhs->_width) {
+    return false;
+  }
+  if (lhs->_storage == rhs->_storage || lhs->count == 0) {
+    return true;
+  }
+  /* memcmp() is vectorized by libc and stops at the first difference. */
+  return memcmp(lhs->_storage, rhs->_storage, lhs->count * lhs->_width) == 0;
+}
+
+/* MARK: - Combining Arrays */
+
+void array_combine(struct Array* array, struct Array* other) {
+  if (array->_width != other->_width) {
+    fprintf(stderr, ARRAY_FATAL_ERR_WIDTH);
+    abort();
+  }
+  /*
+   * Take the count before growing: if `other` is `array` itself, the storage
+   * may move but the number of elements to copy stays the same.
+   */
+  var n = other->count;
+  if (n == 0) {
+    return;
+  }
+  _array_grow(array, array->count + n);
+  _array_make_unique(array);
+  memcpy(
+    array->_storage + array->count * array->_width,
+    other->_storage,
+    n * array->_width
+  );
+  array->count += n;
+  array->is_empty = false;
+}
+
+/* MARK: - Reading and Writing Arrays */
+
+/* The header of a file written by `array_write()`, in native byte order. */
+struct _ArrayFileHeader {
+  char magic[8];
+  UInt32 version;
+  UInt32 width;
+  Int64 count;
+  /* FNV-1a over the elements, taken 8 bytes at a time. */
+  UInt64 checksum;
+  /* _ARRAY_FILE_BYTE_ORDER as written, to reject other byte orders. */
+  UInt32 byte_order;
+  UInt8 reserved[28];
+};
+
+#define _ARRAY_FILE_BYTE_ORDER 0x01020304u
+
+_Static_assert(
+  sizeof(struct _ArrayFileHeader) == ARRAY_FILE_HEADER_SIZE,
+  "The array file header must be ARRAY_FILE_HEADER_SIZE bytes"
+);
+
 /*
- * Returns a Boolean value indicating whether two arrays contain the same
- * elements in the same order.
+ * A variant of FNV-1a that consumes 8 bytes per multiplication instead of 1,
+ * so checking a large file isn't bound by the hash.
  */
-//bool array_equal(
-//  struct Array* lhs,
-//  struct Array* rhs/*,
-//  int (*elem_compare)(const void*, const void*)*/
-//) {
-//  if ((*lhs).count != (*rhs).count) {
-//    return false;
-//  }
-//  if (
-//    memcmp(
-//      (*lhs)._storage,
-//      (*rhs)._storage,
-//      (*lhs).count * (*lhs).width
-//    ) != 0
-//  ) {
-//    return false;
-//  }
-//  return true;
-//}
+static UInt64 _array_checksum(const UInt8* bytes, Int64 size) {
+  var hash = 0xcbf29ce484222325ull;
+  var i = 0ll;
+  for (; i + 8 <= size; i += 8) {
+    UInt64 word;
+    memcpy(&word, bytes + i, 8);
+    hash = (hash ^ word) * 0x100000001b3ull;
+  }
+  for (; i < size; i += 1) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
 
-/* MARK: - Combining Arrays */
+/* Writes all `size` bytes, retrying short writes and interruptions. */
+static Bool _array_write_all(Int32 fd, const UInt8* bytes, Int64 size) {
+  while (size > 0) {
+    var written = write(fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
 
-/* 
- * Appends the elements of an array to this array.
- * NEVER do array_combine(&array, &array);
+/* Reads all `size` bytes, failing with EINVAL if the file ends early. */
+static Bool _array_read_all(Int32 fd, UInt8* bytes, Int64 size) {
+  while (size > 0) {
+    var n = read(fd, bytes, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (n == 0) {
+      errno = EINVAL;
+      return false;
+    }
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+/*
+ * Returns true if `header` was written by this version of `array_write()` on a
+ * machine with the same byte order, and describes a sensible array.
  */
-//void array_combine(struct Array* array, struct Array* other) {
-//  if (array->width != (*other).width) {
-//    return;
-//  }
-//  var original_count = array->count;
-//  array->is_empty = array->is_empty && (*other).is_empty;
-//  
-//  /* Dummy append for allocating spaces */
-//  var i = 0;
-//  for (i = 0; i < (*other).count; i += 1) {
-//    if (array->capacity == 0) {
-//      array->_storage = realloc(array->_storage, 1 * array->width);
-//      array->capacity = 1;
-//    }
-//    if (array->count == array->capacity) {
-//      array->capacity *= ARRAY_MULTIPLE_FACTOR;
-//      var new_size = array->capacity * array->width;
-//      array->_storage = realloc(array->_storage, new_size);
-//    }
-//    array->count += 1;
-//  }
-//  
-//  memcpy(
-//    array->_storage + original_count * array->width,
-//    (*other)._storage,
-//    (*other).count * (*other).width
-//  );
-//}
+static Bool _array_check_header(const struct _ArrayFileHeader* header) {
+  return memcmp(header->magic, ARRAY_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+         header->version == ARRAY_FILE_VERSION &&
+         header->byte_order == _ARRAY_FILE_BYTE_ORDER &&
+         header->width > 0 &&
+         header->count >= 0 &&
+         header->count <= INT64_MAX / header->width;
+}
+
+Bool array_write(struct Array* array, Int32 fd) {
+  var size = array->count * array->_width;
+  struct _ArrayFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ARRAY_FILE_MAGIC, sizeof(header.magic));
+  header.version = ARRAY_FILE_VERSION;
+  header.width = array->_width;
+  header.count = array->count;
+  header.checksum = _array_checksum(array->_storage, size);
+  header.byte_order = _ARRAY_FILE_BYTE_ORDER;
+  
+  return _array_write_all(fd, (const UInt8*)&header, sizeof(header)) &&
+         _array_write_all(fd, array->_storage, size);
+}
+
+struct Array* array_read(Int32 fd) {
+  struct _ArrayFileHeader header;
+  if (!_array_read_all(fd, (UInt8*)&header, sizeof(header))) {
+    return NULL;
+  }
+  if (!_array_check_header(&header)) {
+    errno = EINVAL;
+    return NULL;
+  }
+  
+  /*
+   * The header is checked against what is left of a regular file before
+   * anything is allocated, so a corrupt count can't ask for more memory than
+   * the file could fill. `_array_check_header()` already ruled out overflow.
+   */
+  var size = header.count * header.width;
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    return NULL;
+  }
+  if (S_ISREG(status.st_mode)) {
+    var offset = (Int64)lseek(fd, 0, SEEK_CUR);
+    if (offset < 0) {
+      return NULL;
+    }
+    if (size > (Int64)status.st_size - offset) {
+      errno = EINVAL;
+      return NULL;
+    }
+  }
+  
+  /* Read straight into storage of the final size. */
+  var array = _array_create(header.width, header.count, 0, NULL);
+  if (array == NULL) {
+    return NULL;
+  }
+  if (!_array_read_all(fd, array->_storage, size)) {
+    array_deinit(array);
+    return NULL;
+  }
+  if (_array_checksum(array->_storage, size) != header.checksum) {
+    array_deinit(array);
+    errno = EINVAL;
+    return NULL;
+  }
+  array->count = header.count;
+  array->is_empty = header.count == 0;
+  return array;
+}
+
+struct Array* array_map_file(const char* path) {
+  var fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    return NULL;
+  }
+  var file_size = (Int64)status.st_size;
+  if (file_size < ARRAY_FILE_HEADER_SIZE) {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  /* The mapping stays valid after the descriptor is closed. */
+  UInt8* mapping = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return NULL;
+  }
+  
+  struct _ArrayFileHeader header;
+  memcpy(&header, mapping, sizeof(header));
+  if (
+    !_array_check_header(&header) ||
+    header.count * header.width > file_size - ARRAY_FILE_HEADER_SIZE
+  ) {
+    munmap(mapping, file_size);
+    errno = EINVAL;
+    return NULL;
+  }
+  
+  var array = _array_create(header.width, 0, 0, NULL);
+  if (array == NULL) {
+    munmap(mapping, file_size);
+    return NULL;
+  }
+  array->_storage = mapping + ARRAY_FILE_HEADER_SIZE;
+  array->_capacity = header.count;
+  array->count = header.count;
+  array->is_empty = header.count == 0;
+  array->_is_mapped = true;
+  array->_is_read_only = true;
+  array->_mapped_size = file_size;
+  return array;
+}
 
 /*===----------------------------------------------------------------------===*/
 /*             ___                            ___                             */
@@ -18,15 +18,48 @@
 
 #include <stdio.h> /* For printing error messages */
 
+#include "allocator.h"
 #include "sort.h"
 
 #define ARRAY_MULTIPLE_FACTOR 2
 #define ARRAY_RESIZE_FACTOR   4
+#define ARRAY_HYSTERESIS_FACTOR 8
 
 #define ARRAY_FATAL_ERR_MALLOC "malloc() return a NULL pointer, check errno"
 #define ARRAY_FATAL_ERR_REALLO "realloc() return a NULL pointer, check errno"
 #define ARRAY_FATAL_ERR_REMEM  "Can't remove last element from an empty array"
 #define ARRAY_FATAL_ERR_OUTOB  "Index out of range"
+#define ARRAY_FATAL_ERR_WIDTH  "Can't combine arrays of different element sizes"
+#define ARRAY_FATAL_ERR_MMAP   "mmap() or mremap() failed, check errno"
+#define ARRAY_FATAL_ERR_PERM   "The indices are not a permutation of the array"
+
+/* A reasonable threshold for `array_set_mapping_threshold()`: 64 MiB. */
+#define ARRAY_DEFAULT_MAPPING_THRESHOLD (64ll << 20)
+
+/*
+ * The file format of `array_write()`: a header of ARRAY_FILE_HEADER_SIZE bytes
+ * starting with ARRAY_FILE_MAGIC (including its NUL), followed by the elements
+ * as they are laid out in memory.
+ */
+#define ARRAY_FILE_MAGIC "CCARRAY"
+#define ARRAY_FILE_VERSION 1
+#define ARRAY_FILE_HEADER_SIZE 64
+
+/* How an array releases storage when elements are removed. */
+enum ArrayShrinkPolicy {
+  /*
+   * Halves the capacity whenever the count drops to a quarter of it. This is
+   * the default.
+   */
+  ARRAY_SHRINK_POLICY_HALVE,
+  /* Never releases storage when removing elements. */
+  ARRAY_SHRINK_POLICY_NEVER,
+  /*
+   * Halves the capacity only when the count drops to an eighth of it, so an
+   * array oscillating around a power of two doesn't reallocate on every step.
+   */
+  ARRAY_SHRINK_POLICY_HYSTERESIS
+};
 
 struct Array {
   void* _storage;
@@ -62,8 +95,70 @@ struct Array {
    * property instead of checking that the `count` property is equal to zero.
    */
   Bool is_empty;
+  
+  /* The policy used by removing functions to release storage. */
+  enum ArrayShrinkPolicy _shrink_policy;
+  
+  /* A Boolean value indicating whether `array_remove_all()` keeps storage. */
+  Bool _keeps_capacity;
+  
+  /* The source of the storage, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
+  
+  /*
+   * The number of elements that fit in the storage placed right after the
+   * Array structure, in the same allocation. While the count stays within it,
+   * `_storage` points there and the array needs no separate heap block.
+   */
+  Int64 _inline_capacity;
+  
+  /*
+   * The storage size (in bytes) from which the elements are kept in an
+   * anonymous memory mapping instead of the allocator. 0 disables mapping.
+   */
+  Int64 _mapping_threshold;
+  
+  /* The size of the mapping (in bytes) if `_is_mapped` is true. */
+  Int64 _mapped_size;
+  
+  /* A Boolean value indicating whether `_storage` is a memory mapping. */
+  Bool _is_mapped;
+  
+  /* A Boolean value indicating whether mappings ask for huge pages. */
+  Bool _uses_huge_pages;
+  
+  /*
+   * A Boolean value indicating whether `_storage` points into a read-only file
+   * mapping from `array_map_file()`. Such storage is always copied before a
+   * change, as if it were shared.
+   */
+  Bool _is_read_only;
+  
+  /*
+   * The number of arrays sharing `_storage` after `array_snapshot()`, or NULL
+   * if the storage has never been shared. It is updated atomically, and the
+   * storage is copied before any change while the count is above 1.
+   */
+  Int64* _reference_count;
 };
 
+/*
+ * Returns a pointer to the element at `index` of `array`.
+ *
+ * This is `array_at()` in debug builds. When `NDEBUG` is defined it skips the
+ * bounds check and compiles down to a single address computation. Arguments
+ * may be evaluated more than once.
+ *
+ * In release builds it doesn't copy storage shared with a snapshot, so only
+ * write through it after a call that does, such as `array_span()`.
+ */
+#ifdef NDEBUG
+#define ARRAY_AT(array, index)                                                \
+  ((void*)((UInt8*)(array)->_storage + (Int64)(array)->_width * (index)))
+#else
+#define ARRAY_AT(array, index) array_at((array), (index))
+#endif
+
 /*----------------------------------------------------------------------------*/
 /**
  * Creates an empty array.
@@ -78,6 +173,61 @@ struct Array {
  */
 struct Array* array_init(UInt32 width);
 
+/**
+ * Creates an empty array with preallocated storage.
+ *
+ * Use this function when you know how many elements the array will hold, so
+ * that filling it never reallocates.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *   - capacity: The number of elements the array can hold before it needs to
+ *     allocate new storage. The storage is allocated exactly, not rounded.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct Array* array_init_with_capacity(UInt32 width, Int64 capacity);
+
+/**
+ * Creates an empty array that stores its first elements inline.
+ *
+ * The first `inline_capacity` elements are kept in the same allocation as the
+ * Array structure; the array only allocates separate storage once it grows
+ * beyond that, and moves back when it shrinks again. This saves one heap
+ * allocation and a pointer indirection for the many arrays that stay small.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *   - inline_capacity: The number of elements stored inline.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct Array* array_init_with_inline_capacity(
+  UInt32 width,
+  Int64 inline_capacity
+);
+
+/**
+ * Creates an empty array that takes its memory from a custom allocator.
+ *
+ * Both the Array structure and its storage are allocated from `allocator`, and
+ * are returned to it by `array_deinit()`.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *   - allocator: The allocator to use, which must outlive the array. Pass NULL
+ *     to use the system allocator.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct Array* array_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+);
+
 /**
  * Destroys an array.
  *
@@ -89,6 +239,23 @@ struct Array* array_init(UInt32 width);
  */
 void array_deinit(struct Array* array);
 
+/**
+ * Creates a snapshot of an array in constant time.
+ *
+ * The snapshot shares the storage of `array` instead of copying it. Whichever
+ * of the two is changed next copies the storage first (copy-on-write), so
+ * changes to one are never seen by the other. The reference count of shared
+ * storage is atomic, so a snapshot may be read and destroyed on another thread
+ * while the original is changed. Elements stored inline are copied right away.
+ *
+ * The snapshot takes its memory from the allocator of `array`, which must be
+ * safe to call from every thread that destroys one of them.
+ *
+ * - Returns: A new array with the same elements, to be destroyed with
+ * `array_deinit()`. If the allocation fails, it returns NULL.
+ */
+struct Array* array_snapshot(struct Array* array);
+
 /**
  * Adds a new element at the end of the array.
  *
@@ -106,6 +273,54 @@ void array_deinit(struct Array* array);
  */
 void array_append(struct Array* array, void* new_element);
 
+/**
+ * Adds the elements of a buffer to the end of the array.
+ *
+ * The storage is grown at most once for the whole batch and the elements are
+ * copied with a single `memcpy()`, so appending _n_ elements is _O(n)_ with
+ * no per-element overhead.
+ *
+ * - Parameters:
+ *   - base: A pointer to the first of `n` contiguous elements to append. The
+ *     buffer must not overlap the array's storage.
+ *   - n: The number of elements to append.
+ */
+void array_append_contents(struct Array* array, const void* base, Int64 n);
+
+/**
+ * Inserts a new element at the specified position.
+ *
+ * The elements at `index` and after are shifted by one position with a single
+ * `memmove()`.
+ *
+ * - Parameters:
+ *   - index: The position at which to insert the new element. `index` must be
+ *     a valid index of the array or equal to its `count` property.
+ *   - new_element: The new element to insert into the array.
+ *
+ * - Complexity: _O(n)_, where _n_ is the length of the array.
+ */
+void array_insert(struct Array* array, Int64 index, void* new_element);
+
+/**
+ * Inserts the elements of a buffer at the specified position.
+ *
+ * The storage grows at most once and the tail of the array is shifted once,
+ * so inserting _m_ elements costs _O(n + m)_ rather than _O(n * m)_.
+ *
+ * - Parameters:
+ *   - index: The position at which to insert the elements, in `0...count`.
+ *   - base: A pointer to the first of `n` contiguous elements to insert. The
+ *     buffer must not overlap the array's storage.
+ *   - n: The number of elements to insert.
+ */
+void array_insert_contents(
+  struct Array* array,
+  Int64 index,
+  const void* base,
+  Int64 n
+);
+
 /**
  * Removes the last element of the array.
  *
@@ -115,11 +330,112 @@ void array_append(struct Array* array, void* new_element);
  */
 void array_remove_last(struct Array* array);
 
+/**
+ * Removes the element at the specified position.
+ *
+ * - Parameters:
+ *   - index: The position of the element to remove. `index` must be a valid
+ *     index of the array.
+ *
+ * - Complexity: _O(n)_, where _n_ is the length of the array.
+ */
+void array_remove_at(struct Array* array, Int64 index);
+
+/**
+ * Removes the elements in the range `start ..< end`.
+ *
+ * The tail of the array is shifted once and the storage shrinks at most once,
+ * so removing _k_ elements costs _O(n)_ rather than _O(n * k)_.
+ *
+ * - Parameters:
+ *   - start: The position of the first element to remove.
+ *   - end: The position after the last element to remove. The range must
+ *     satisfy `0 ≤ start ≤ end ≤ count`.
+ */
+void array_remove_subrange(struct Array* array, Int64 start, Int64 end);
+
 /**
  * Removes all elements from the array.
  */
 void array_remove_all(struct Array* array);
 
+/**
+ * Removes all the elements that satisfy the given predicate.
+ *
+ * The survivors keep their relative order. They are compacted in a single
+ * forward pass that moves each run of survivors with one `memmove()`, and the
+ * storage shrinks at most once at the end, so the whole call is _O(n)_.
+ *
+ * - Parameters:
+ *   - should_be_removed: A function that takes a pointer to an element of the
+ *     array and `context`, and returns true if the element should be removed.
+ *     It is called exactly once for each element, in order.
+ *   - context: An opaque pointer passed to `should_be_removed`.
+ */
+void array_remove_all_where(
+  struct Array* array,
+  Bool (*should_be_removed)(const void* element, void* context),
+  void* context
+);
+
+/**
+ * Replaces the elements in the range `start ..< end` with the elements of a
+ * buffer.
+ *
+ * The number of new elements need not match the number of elements being
+ * removed. The tail of the array is moved with a single `memmove()`.
+ *
+ * - Parameters:
+ *   - start: The position of the first element to replace.
+ *   - end: The position after the last element to replace. The range must
+ *     satisfy `0 ≤ start ≤ end ≤ count`.
+ *   - base: A pointer to the first of `n` contiguous new elements. The buffer
+ *     must not overlap the array's storage.
+ *   - n: The number of new elements.
+ *
+ * - Complexity: _O(n + m)_, where _n_ is the length of the array and _m_ is
+ *   the number of new elements.
+ */
+void array_replace_subrange(
+  struct Array* array,
+  Int64 start,
+  Int64 end,
+  const void* base,
+  Int64 n
+);
+
+/**
+ * Returns the first index where the specified value appears in the array.
+ *
+ * Elements are compared byte by byte with `key`, so this is meant for
+ * plain-old-data elements without padding (integers, floating-point numbers
+ * compared by representation, packed structures). For elements of width 2, 4,
+ * 8 and 16 the search uses SSE2 or AVX2 vector comparisons when the compiler
+ * targets them, and scalar integer comparisons otherwise; single bytes are
+ * searched with `memchr()`.
+ *
+ * - Parameters:
+ *   - key: A pointer to the value to search for, `width` bytes long.
+ *
+ * - Returns: The index of the first matching element, or -1 if there is none.
+ */
+Int64 array_first_index_of_bytes(struct Array* array, const void* key);
+
+/**
+ * Returns a Boolean value indicating whether the array contains the given
+ * value, compared byte by byte. See `array_first_index_of_bytes()`.
+ */
+Bool array_contains_bytes(struct Array* array, const void* key);
+
+/**
+ * Returns a Boolean value indicating whether two arrays contain the same
+ * elements in the same order.
+ *
+ * Elements are compared byte by byte, like `array_first_index_of_bytes()`.
+ * Arrays of different element sizes are never equal.
+ */
+Bool array_equal(struct Array* lhs, struct Array* rhs);
+
 /**
  * Sorts the array in place.
  *
@@ -136,11 +452,232 @@ void array_sort(
   Int32 (*compare)(const void*, const void*)
 );
 
+/**
+ * Sorts the array in place, splitting the work across threads. See
+ * `sort_parallel()`.
+ *
+ * - Parameters:
+ *   - thread_count: The number of threads to use, including the calling
+ *                   one, or 0 to use one per online processor.
+ */
+void array_sort_parallel(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*),
+  Int64 thread_count
+);
+
+/**
+ * Sorts the array in place by a numeric key stored in each element. See
+ * `radix_sort()`.
+ *
+ * - Parameters:
+ *   - key_offset: The offset of the key within an element.
+ *   - key_type: The type of the key.
+ */
+void array_radix_sort(
+  struct Array* array,
+  size_t key_offset,
+  enum SortKeyType key_type
+);
+
+/**
+ * Sorts the array in place, keeping elements that compare equal in their
+ * original order. See `stable_sort()`.
+ */
+void array_stable_sort(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*)
+);
+
+/**
+ * Returns the indices that would sort the array, leaving the array unchanged.
+ * See `sort_indices()`.
+ *
+ * - Returns: A new array of `Int64` that uses the allocator of `array`,
+ * which you must destroy with `array_deinit()`. If the allocation fails, it
+ * returns NULL.
+ */
+struct Array* array_argsort(
+  struct Array* array,
+  Int32 (*compare)(const void*, const void*)
+);
+
+/**
+ * Reorders the array so that the element at position `i` is the one that was
+ * at `permutation[i]`.
+ *
+ * Each cycle of the permutation is followed once, so every element is moved
+ * exactly once, and only one element is held aside at a time. Together with
+ * `array_argsort()` this sorts an array of wide elements while moving each
+ * of them only once:
+ *
+ * ```c
+ * var permutation = array_argsort(records, compare);
+ * array_apply_permutation(records, permutation);
+ * array_deinit(permutation);
+ * ```
+ *
+ * - Parameters:
+ *   - permutation: An array of `Int64` holding each index of `array` once.
+ *                  It is modified while the elements move, and restored
+ *                  before returning.
+ */
+void array_apply_permutation(
+  struct Array* array,
+  struct Array* permutation
+);
+
+/**
+ * Reserves enough space to store the specified number of elements.
+ *
+ * If `minimum_capacity` is not larger than the current capacity, this function
+ * does nothing. Otherwise the storage is reallocated to hold exactly
+ * `minimum_capacity` elements, so later appends up to that count never
+ * reallocate.
+ *
+ * - Parameters:
+ *   - minimum_capacity: The requested number of elements to store.
+ */
+void array_reserve(struct Array* array, Int64 minimum_capacity);
+
+/**
+ * Releases the unused part of the array's storage.
+ *
+ * After this call the capacity of the array equals its count.
+ */
+void array_shrink_to_fit(struct Array* array);
+
+/**
+ * Sets how the array releases storage when elements are removed.
+ *
+ * Arrays used as stacks, or drained and refilled over and over, should use
+ * `ARRAY_SHRINK_POLICY_NEVER` (or `ARRAY_SHRINK_POLICY_HYSTERESIS`) together
+ * with `keeps_capacity`, so that they stop allocating once warmed up.
+ *
+ * - Parameters:
+ *   - policy: The policy used by `array_remove_last()`.
+ *   - keeps_capacity: Pass true to make `array_remove_all()` keep the storage
+ *     instead of freeing it.
+ */
+void array_set_shrink_policy(
+  struct Array* array,
+  enum ArrayShrinkPolicy policy,
+  Bool keeps_capacity
+);
+
+/**
+ * Lets a large array keep its elements in an anonymous memory mapping.
+ *
+ * Once the storage of the array reaches `threshold` bytes it is moved into a
+ * private anonymous `mmap()`, and later growth uses `mremap()`, which remaps
+ * pages instead of copying the elements. This keeps the latency of appends
+ * flat and the peak memory usage at the size of the array. The storage moves
+ * back to the allocator when it shrinks below `threshold`.
+ *
+ * Mapping is only available on Linux; elsewhere this function has no effect.
+ *
+ * - Parameters:
+ *   - threshold: The storage size in bytes from which the array is mapped,
+ *     e.g. `ARRAY_DEFAULT_MAPPING_THRESHOLD`. Pass 0 to disable mapping.
+ *   - uses_huge_pages: Pass true to advise the kernel to back the mapping with
+ *     transparent huge pages.
+ */
+void array_set_mapping_threshold(
+  struct Array* array,
+  Int64 threshold,
+  Bool uses_huge_pages
+);
+
 /* Returns the element at the specified position. */
 void array_get(struct Array* array, Int64 index, void* element);
 
+/**
+ * Returns a pointer to the element at the specified position.
+ *
+ * The element is accessed in place, without copying it. The pointer is valid
+ * until the next call that changes the capacity of the array (e.g. appending
+ * or removing elements). If the storage is shared with a snapshot, it is
+ * copied first, since the pointer may be written through.
+ */
+void* array_at(struct Array* array, Int64 index);
+
+/**
+ * Returns a pointer to the contiguous storage of the array.
+ *
+ * The array's elements are laid out back to back, so hot loops can scan the
+ * returned buffer directly and let the compiler vectorize them. The pointer is
+ * invalidated like the one returned by `array_at()`.
+ *
+ * - Parameters:
+ *   - count: If not NULL, receives the number of elements in the buffer.
+ *
+ * - Returns: A pointer to the first element, or NULL if the array has never
+ * allocated storage.
+ */
+void* array_span(struct Array* array, Int64* count);
+
 /* Replaces the element at the specified position. */
 void array_set(struct Array* array, Int64 index, void* element);
+
+/**
+ * Appends the elements of another array to the end of this array.
+ *
+ * Both arrays must store elements of the same size. `other` may be `array`
+ * itself, in which case the array's contents are doubled.
+ *
+ * - Parameters:
+ *   - other: The array whose elements are appended.
+ */
+void array_combine(struct Array* array, struct Array* other);
+
+/**
+ * Writes the elements of an array to a file.
+ *
+ * The file starts with a small versioned header holding the element width,
+ * the count and a checksum of the elements, followed by the elements exactly
+ * as they are stored in memory. It can be loaded with `array_read()` or
+ * mapped with `array_map_file()` by a machine with the same byte order.
+ *
+ * - Parameters:
+ *   - fd: A file descriptor open for writing, positioned where the array
+ *         should start.
+ *
+ * - Returns: true on success. On failure, returns false and `errno` is set.
+ */
+Bool array_write(struct Array* array, Int32 fd);
+
+/**
+ * Reads an array written by `array_write()`.
+ *
+ * - Parameters:
+ *   - fd: A file descriptor open for reading, positioned at the header.
+ *
+ * - Returns: A new array holding the elements. If the file can't be read, the
+ * header is not recognized, it claims more elements than the rest of a
+ * regular file holds or the checksum doesn't match, it returns NULL and
+ * `errno` is set (EINVAL for a malformed file).
+ */
+struct Array* array_read(Int32 fd);
+
+/**
+ * Maps a file written by `array_write()` into memory and returns an array
+ * whose storage points directly into the mapping.
+ *
+ * No element is read or copied, so loading takes the same time for any file
+ * size; pages are brought in on first access. The checksum is not verified,
+ * since that would read the whole file; use `array_read()` for untrusted
+ * files.
+ *
+ * The mapping is read-only. Reading with `array_get()` or `_storage` uses it
+ * directly, while the first change, or any call that hands out a writable
+ * pointer such as `array_at()` and `array_span()`, copies the elements to
+ * ordinary storage first, like a snapshot (see `array_snapshot()`). The file
+ * is unmapped by `array_deinit()`.
+ *
+ * - Returns: A new read-only array. If the file can't be mapped or the header
+ * is not recognized, it returns NULL and `errno` is set.
+ */
+struct Array* array_map_file(const char* path);
 /*----------------------------------------------------------------------------*/
 
 #endif /* array_h */
@@ -0,0 +1,229 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef array_template_h
+#define array_template_h
+
+#include "types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "array.h"
+
+/*
+ * Defines an array specialized for one element type.
+ *
+ * `ARRAY_DEFINE(Name, prefix, Element)` emits `struct Name` and a set of
+ * `static` functions named `prefix_xxx` with the same semantics as the
+ * corresponding functions of `struct Array`. Because the element type is known
+ * at compile time, accesses are plain loads and stores instead of `memcpy()`
+ * calls with a runtime width. The functions aren't declared `inline`, which
+ * C89 lacks, so the template also compiles with `-ansi`.
+ *
+ * Example:
+ *
+ *   ARRAY_DEFINE(Int64Array, int64_array, Int64)
+ *
+ *   var array = int64_array_init();
+ *   int64_array_append(array, 19358);
+ *   var first = int64_array_get(array, 0);
+ *   int64_array_deinit(array);
+ *
+ * Emitted functions:
+ *   struct Name* prefix_init(void);
+ *   struct Name* prefix_init_with_allocator(const struct Allocator*);
+ *   void prefix_deinit(struct Name*);
+ *   void prefix_reserve(struct Name*, Int64 minimum_capacity);
+ *   void prefix_append(struct Name*, Element);
+ *   void prefix_append_contents(struct Name*, const Element*, Int64 n);
+ *   void prefix_remove_last(struct Name*);
+ *   void prefix_remove_all(struct Name*);
+ *   Element prefix_get(struct Name*, Int64 index);
+ *   void prefix_set(struct Name*, Int64 index, Element);
+ *   Element* prefix_at(struct Name*, Int64 index);
+ */
+#define ARRAY_DEFINE(Name, prefix, Element)                                   \
+struct Name {                                                                 \
+  Element* _storage;                                                          \
+                                                                              \
+  /* The number of elements in the array. */                                  \
+  Int64 count;                                                                \
+                                                                              \
+  /* The number of elements the storage can hold. */                          \
+  Int64 _capacity;                                                            \
+                                                                              \
+  /* A Boolean value indicating whether the array is empty. */                \
+  Bool is_empty;                                                              \
+                                                                              \
+  /* The source of the storage, or NULL for the system allocator. */          \
+  const struct Allocator* _allocator;                                         \
+};                                                                            \
+                                                                              \
+static void prefix##_reallocate(struct Name* array, Int64 capacity) {         \
+  var new_size = capacity * (Int64)sizeof(Element);                           \
+  array->_storage = allocator_reallocate(                                     \
+    array->_allocator,                                                        \
+    array->_storage,                                                          \
+    array->_capacity * sizeof(Element),                                       \
+    new_size                                                                  \
+  );                                                                          \
+  if (array->_storage == NULL && new_size != 0) {                             \
+    fprintf(stderr, ARRAY_FATAL_ERR_REALLO);                                  \
+    abort();                                                                  \
+  }                                                                           \
+  array->_capacity = capacity;                                                \
+}                                                                             \
+                                                                              \
+/* Rounds `count` up to the next power of 2. `count` must be positive. */     \
+static Int64 prefix##_round_up_capacity(Int64 count) {                        \
+  var capacity = (UInt64)count - 1;                                           \
+  capacity |= capacity >> 1;                                                  \
+  capacity |= capacity >> 2;                                                  \
+  capacity |= capacity >> 4;                                                  \
+  capacity |= capacity >> 8;                                                  \
+  capacity |= capacity >> 16;                                                 \
+  capacity |= capacity >> 32;                                                 \
+  capacity += 1;                                                              \
+  return (Int64)capacity;                                                     \
+}                                                                             \
+                                                                              \
+static void prefix##_grow(struct Name* array, Int64 minimum_capacity) {       \
+  if (minimum_capacity <= array->_capacity) {                                 \
+    return;                                                                   \
+  }                                                                           \
+  var capacity = prefix##_round_up_capacity(minimum_capacity);                \
+  if (capacity < array->_capacity * ARRAY_MULTIPLE_FACTOR) {                  \
+    capacity = array->_capacity * ARRAY_MULTIPLE_FACTOR;                      \
+  }                                                                           \
+  prefix##_reallocate(array, capacity);                                       \
+}                                                                             \
+                                                                              \
+static void prefix##_check_index(struct Name* array, Int64 index) {           \
+  if (index >= array->count || index < 0) {                                   \
+    fprintf(stderr, ARRAY_FATAL_ERR_OUTOB);                                   \
+    abort();                                                                  \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static struct Name* prefix##_init_with_allocator(                             \
+  const struct Allocator* allocator                                           \
+) {                                                                           \
+  struct Name* array;                                                         \
+  if ((array = allocator_allocate(allocator, sizeof(struct Name))) == NULL) { \
+    return NULL;                                                              \
+  }                                                                           \
+  array->_storage = NULL;                                                     \
+  array->count = 0;                                                           \
+  array->_capacity = 0;                                                       \
+  array->is_empty = true;                                                     \
+  array->_allocator = allocator;                                              \
+  return array;                                                               \
+}                                                                             \
+                                                                              \
+static struct Name* prefix##_init(void) {                                     \
+  return prefix##_init_with_allocator(NULL);                                  \
+}                                                                             \
+                                                                              \
+static void prefix##_deinit(struct Name* array) {                             \
+  if (array == NULL) {                                                        \
+    return;                                                                   \
+  }                                                                           \
+  var allocator = array->_allocator;                                          \
+  allocator_deallocate(                                                       \
+    allocator,                                                                \
+    array->_storage,                                                          \
+    array->_capacity * sizeof(Element)                                        \
+  );                                                                          \
+  allocator_deallocate(allocator, array, sizeof(struct Name));                \
+}                                                                             \
+                                                                              \
+static void prefix##_reserve(                                                 \
+  struct Name* array,                                                         \
+  Int64 minimum_capacity                                                      \
+) {                                                                           \
+  if (minimum_capacity > array->_capacity) {                                  \
+    prefix##_reallocate(array, minimum_capacity);                             \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void prefix##_append(struct Name* array, Element new_element) {        \
+  prefix##_grow(array, array->count + 1);                                     \
+  array->_storage[array->count] = new_element;                                \
+  array->count += 1;                                                          \
+  array->is_empty = false;                                                    \
+}                                                                             \
+                                                                              \
+static void prefix##_append_contents(                                         \
+  struct Name* array,                                                         \
+  const Element* base,                                                        \
+  Int64 n                                                                     \
+) {                                                                           \
+  if (n <= 0) {                                                               \
+    return;                                                                   \
+  }                                                                           \
+  prefix##_grow(array, array->count + n);                                     \
+  memcpy(array->_storage + array->count, base, n * sizeof(Element));          \
+  array->count += n;                                                          \
+  array->is_empty = false;                                                    \
+}                                                                             \
+                                                                              \
+static void prefix##_remove_last(struct Name* array) {                        \
+  if (array->is_empty) {                                                      \
+    fprintf(stderr, ARRAY_FATAL_ERR_REMEM);                                   \
+    abort();                                                                  \
+  }                                                                           \
+  array->count -= 1;                                                          \
+  if (array->count == 0) {                                                    \
+    array->is_empty = true;                                                   \
+  }                                                                           \
+  var capacity = array->_capacity;                                            \
+  while (capacity > 0 && array->count * ARRAY_RESIZE_FACTOR <= capacity) {    \
+    capacity /= ARRAY_MULTIPLE_FACTOR;                                        \
+  }                                                                           \
+  if (capacity != array->_capacity) {                                         \
+    prefix##_reallocate(array, capacity);                                     \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void prefix##_remove_all(struct Name* array) {                         \
+  allocator_deallocate(                                                       \
+    array->_allocator,                                                        \
+    array->_storage,                                                          \
+    array->_capacity * sizeof(Element)                                        \
+  );                                                                          \
+  array->_storage = NULL;                                                     \
+  array->count = 0;                                                           \
+  array->_capacity = 0;                                                       \
+  array->is_empty = true;                                                     \
+}                                                                             \
+                                                                              \
+static Element prefix##_get(struct Name* array, Int64 index) {                \
+  prefix##_check_index(array, index);                                         \
+  return array->_storage[index];                                              \
+}                                                                             \
+                                                                              \
+static void prefix##_set(                                                     \
+  struct Name* array,                                                         \
+  Int64 index,                                                                \
+  Element element                                                             \
+) {                                                                           \
+  prefix##_check_index(array, index);                                         \
+  array->_storage[index] = element;                                           \
+}                                                                             \
+                                                                              \
+static Element* prefix##_at(struct Name* array, Int64 index) {                \
+  prefix##_check_index(array, index);                                         \
+  return array->_storage + index;                                             \
+}
+
+#endif /* array_template_h */
@@ -0,0 +1,238 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* ColumnArray START                                    /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "column_array.h"
+
+#include "array.h" /* For ARRAY_MULTIPLE_FACTOR and ARRAY_RESIZE_FACTOR */
+
+/*
+ * The size of the single block holding the structure and the per-column
+ * pointers, widths and offsets.
+ */
+static size_t _column_array_header_size(Int64 column_count) {
+  return sizeof(struct ColumnArray) +
+    column_count * (sizeof(void*) + 2 * sizeof(UInt32));
+}
+
+/* Check that the specified `index` is valid, i.e. `0 ≤ index < count`. */
+static void _column_array_check_index(struct ColumnArray* array, Int64 index) {
+  if (index >= array->count || index < 0) {
+    fprintf(stderr, COLUMN_ARRAY_FATAL_ERR_OUTOB);
+    abort();
+  }
+}
+
+static void _column_array_check_column(
+  struct ColumnArray* array,
+  Int64 column
+) {
+  if (column >= array->_column_count || column < 0) {
+    fprintf(stderr, COLUMN_ARRAY_FATAL_ERR_OUTOB);
+    abort();
+  }
+}
+
+/* Resizes every column to hold `capacity` rows. */
+static void _column_array_reallocate(
+  struct ColumnArray* array,
+  Int64 capacity
+) {
+  var column = 0ll;
+  for (column = 0; column < array->_column_count; column += 1) {
+    var width = (size_t)array->_widths[column];
+    var storage = allocator_reallocate(
+      array->_allocator,
+      array->_columns[column],
+      array->_capacity * width,
+      capacity * width
+    );
+    if (storage == NULL && capacity > 0 && width > 0) {
+      fprintf(stderr, COLUMN_ARRAY_FATAL_ERR_REALLO);
+      abort();
+    }
+    array->_columns[column] = storage;
+  }
+  array->_capacity = capacity;
+}
+
+/* MARK: - Creating and Destroying a ColumnArray */
+
+struct ColumnArray* column_array_init(
+  Int64 column_count,
+  const UInt32* widths,
+  const UInt32* offsets
+) {
+  return column_array_init_with_allocator(column_count, widths, offsets, NULL);
+}
+
+struct ColumnArray* column_array_init_with_allocator(
+  Int64 column_count,
+  const UInt32* widths,
+  const UInt32* offsets,
+  const struct Allocator* allocator
+) {
+  struct ColumnArray* array;
+  var size = _column_array_header_size(column_count);
+  if ((array = allocator_allocate(allocator, size)) == NULL) {
+    return NULL;
+  }
+
+  array->_columns = (void**)(array + 1);
+  array->_widths = (UInt32*)(array->_columns + column_count);
+  array->_offsets = array->_widths + column_count;
+  array->_column_count = column_count;
+  array->count = 0;
+  array->_capacity = 0;
+  array->_allocator = allocator;
+  array->is_empty = true;
+
+  var offset = 0u;
+  var column = 0ll;
+  for (column = 0; column < column_count; column += 1) {
+    array->_columns[column] = NULL;
+    array->_widths[column] = widths[column];
+    array->_offsets[column] = offsets == NULL ? offset : offsets[column];
+    offset += widths[column];
+  }
+
+  return array;
+}
+
+void column_array_deinit(struct ColumnArray* array) {
+  if (array == NULL) {
+    return;
+  }
+
+  _column_array_reallocate(array, 0);
+  allocator_deallocate(
+    array->_allocator,
+    array,
+    _column_array_header_size(array->_column_count)
+  );
+}
+
+/* MARK: - Adding Elements */
+
+void column_array_reserve(struct ColumnArray* array, Int64 minimum_capacity) {
+  if (minimum_capacity > array->_capacity) {
+    _column_array_reallocate(array, minimum_capacity);
+  }
+}
+
+void column_array_append(struct ColumnArray* array, const void* row) {
+  if (array->count == array->_capacity) {
+    _column_array_reallocate(
+      array,
+      array->_capacity == 0 ? 1 : array->_capacity * ARRAY_MULTIPLE_FACTOR
+    );
+  }
+  array->count += 1;
+  array->is_empty = false;
+  column_array_set(array, array->count - 1, row);
+}
+
+/* MARK: - Removing Elements */
+
+void column_array_remove_last(struct ColumnArray* array) {
+  if (array->is_empty) {
+    fprintf(stderr, COLUMN_ARRAY_FATAL_ERR_REMEM);
+    abort();
+  }
+
+  array->count -= 1;
+  array->is_empty = array->count == 0;
+
+  /* Shrink like an Array with the default policy. */
+  var capacity = array->_capacity;
+  while (capacity > 0 && array->count * ARRAY_RESIZE_FACTOR <= capacity) {
+    capacity /= ARRAY_MULTIPLE_FACTOR;
+  }
+  if (capacity != array->_capacity) {
+    _column_array_reallocate(array, capacity);
+  }
+}
+
+void column_array_remove_all(struct ColumnArray* array) {
+  _column_array_reallocate(array, 0);
+  array->count = 0;
+  array->is_empty = true;
+}
+
+/* MARK: - Accessing Elements */
+
+void column_array_get(struct ColumnArray* array, Int64 index, void* row) {
+  _column_array_check_index(array, index);
+
+  var column = 0ll;
+  for (column = 0; column < array->_column_count; column += 1) {
+    var width = array->_widths[column];
+    memcpy(
+      row + array->_offsets[column],
+      array->_columns[column] + index * width,
+      width
+    );
+  }
+}
+
+void column_array_set(struct ColumnArray* array, Int64 index, const void* row) {
+  _column_array_check_index(array, index);
+
+  var column = 0ll;
+  for (column = 0; column < array->_column_count; column += 1) {
+    var width = array->_widths[column];
+    memcpy(
+      array->_columns[column] + index * width,
+      row + array->_offsets[column],
+      width
+    );
+  }
+}
+
+void* column_array_at(struct ColumnArray* array, Int64 index, Int64 column) {
+  _column_array_check_index(array, index);
+  _column_array_check_column(array, column);
+
+  return array->_columns[column] + index * array->_widths[column];
+}
+
+void* column_array_column(
+  struct ColumnArray* array,
+  Int64 column,
+  Int64* count
+) {
+  _column_array_check_column(array, column);
+
+  if (count != NULL) {
+    *count = array->count;
+  }
+  return array->_columns[column];
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* ColumnArray END                     /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
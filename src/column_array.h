@@ -0,0 +1,197 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef column_array_h
+#define column_array_h
+
+#include "types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+#define COLUMN_ARRAY_FATAL_ERR_REALLO                                         \
+  "realloc() return a NULL pointer, check errno"
+#define COLUMN_ARRAY_FATAL_ERR_REMEM                                          \
+  "Can't remove last element from an empty array"
+#define COLUMN_ARRAY_FATAL_ERR_OUTOB "Index out of range"
+
+/**
+ * An ordered, random-access collection of rows, stored column by column.
+ *
+ * Each field (column) of the rows lives in its own contiguous buffer, and all
+ * buffers share one count and one capacity. Rows are appended and read as a
+ * whole, scattered to and gathered from the columns, while a scan over one
+ * field reads only that field's buffer through `column_array_column()`:
+ *
+ * ```c
+ * struct Trade {
+ *   Int64 time;
+ *   Double price;
+ *   Int32 quantity;
+ * };
+ *
+ * UInt32 widths[] = {sizeof(Int64), sizeof(Double), sizeof(Int32)};
+ * UInt32 offsets[] = {
+ *   offsetof(struct Trade, time),
+ *   offsetof(struct Trade, price),
+ *   offsetof(struct Trade, quantity)
+ * };
+ * var trades = column_array_init(3, widths, offsets);
+ * ...
+ * Int64 count;
+ * Double* prices = column_array_column(trades, 1, &count);
+ * ```
+ */
+struct ColumnArray {
+  /* The buffer of each column. */
+  void** _columns;
+
+  /* The size of each field. */
+  UInt32* _widths;
+
+  /* The offset of each field within a row passed to append, get and set. */
+  UInt32* _offsets;
+
+  /* The number of columns. */
+  Int64 _column_count;
+
+  /**
+   * The number of rows in the array.
+   */
+  Int64 count;
+
+  /* The number of rows each column buffer can hold. */
+  Int64 _capacity;
+
+  /* The source of the storage, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
+
+  /**
+   * A Boolean value indicating whether the array is empty.
+   *
+   * When you need to check whether your array is empty, use the `is_empty`
+   * property instead of checking that the `count` property is equal to zero.
+   */
+  Bool is_empty;
+};
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Creates an empty column array.
+ *
+ * - Parameters:
+ *   - column_count: The number of fields in a row.
+ *   - widths: The size of each field, `column_count` entries.
+ *   - offsets: The offset of each field within a row, `column_count`
+ *              entries, typically from `offsetof()`. Pass NULL for packed
+ *              rows, where each field directly follows the previous one.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct ColumnArray* column_array_init(
+  Int64 column_count,
+  const UInt32* widths,
+  const UInt32* offsets
+);
+
+/**
+ * Creates an empty column array that takes its memory from a custom
+ * allocator. See `column_array_init()`.
+ *
+ * - Parameters:
+ *   - allocator: The allocator to use, which must outlive the array. Pass NULL
+ *     to use the system allocator.
+ */
+struct ColumnArray* column_array_init_with_allocator(
+  Int64 column_count,
+  const UInt32* widths,
+  const UInt32* offsets,
+  const struct Allocator* allocator
+);
+
+/**
+ * Destroys a column array.
+ *
+ * `column_array_deinit()` frees the columns of the array, and the structure
+ * itself. If `array` is a NULL pointer, no operation is performed.
+ */
+void column_array_deinit(struct ColumnArray* array);
+
+/**
+ * Reserves enough space in every column to store the specified number of
+ * rows.
+ *
+ * - Parameters:
+ *   - minimum_capacity: The requested number of rows to store.
+ */
+void column_array_reserve(struct ColumnArray* array, Int64 minimum_capacity);
+
+/**
+ * Adds a new row at the end of the array.
+ *
+ * - Parameters:
+ *   - row: The row to append, laid out as described by the offsets given at
+ *          init time.
+ */
+void column_array_append(struct ColumnArray* array, const void* row);
+
+/**
+ * Removes the last row of the array.
+ *
+ * The array must not be empty.
+ */
+void column_array_remove_last(struct ColumnArray* array);
+
+/**
+ * Removes all rows from the array and frees the columns.
+ */
+void column_array_remove_all(struct ColumnArray* array);
+
+/**
+ * Gathers the row at the specified position into `row`.
+ *
+ * Bytes of `row` that aren't covered by a field, such as padding, are left
+ * unchanged.
+ */
+void column_array_get(struct ColumnArray* array, Int64 index, void* row);
+
+/* Replaces every field of the row at the specified position. */
+void column_array_set(struct ColumnArray* array, Int64 index, const void* row);
+
+/**
+ * Returns a pointer to one field of the row at the specified position.
+ *
+ * The pointer is valid until the next call that adds or removes rows.
+ */
+void* column_array_at(struct ColumnArray* array, Int64 index, Int64 column);
+
+/**
+ * Returns the contiguous buffer of one column.
+ *
+ * The buffer holds `count` fields of the column's width, one per row, and is
+ * valid until the next call that adds or removes rows. It may be NULL if the
+ * array is empty.
+ *
+ * - Parameters:
+ *   - column: The index of the column.
+ *   - count: On return, the number of rows. May be NULL.
+ */
+void* column_array_column(
+  struct ColumnArray* array,
+  Int64 column,
+  Int64* count
+);
+/*----------------------------------------------------------------------------*/
+
+#endif /* column_array_h */
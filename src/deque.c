@@ -38,12 +38,18 @@
 static void _deque_rebalance(struct Array* empty, struct Array* full) {
   var count = empty->count + full->count;
   var half_count = count / 2;
-  /* TODO: use memcpy */
-  /* copy the first half to empty */
+  /* copy the first half to empty, reserving its final size up front */
+  array_reserve(empty, half_count);
   var i = 0ll;
-  for (i = half_count - 1; i >= 0; i -= 1) { /* Important: append backwords */
-    array_append(empty, full->_storage + i * full->_width);
+  for (i = 0; i < half_count; i += 1) { /* Important: copy backwords */
+    memcpy(
+      empty->_storage + i * empty->_width,
+      full->_storage + (half_count - 1 - i) * full->_width,
+      full->_width
+    );
   }
+  empty->count = half_count;
+  empty->is_empty = half_count == 0;
   /* shift the second half to the front of full */
   memmove(
     full->_storage,
@@ -64,19 +70,30 @@ static void _deque_check_index(struct Deque* deque, Int64 index) {
 /* MARK: - Creating and Destroying an Array */
 
 struct Deque* deque_init(UInt32 width) {
+  return deque_init_with_allocator(width, NULL);
+}
+
+struct Deque* deque_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+) {
   struct Deque* deque;
-  if ((deque = malloc(sizeof(struct Deque))) == NULL) {
+  if ((deque = allocator_allocate(allocator, sizeof(struct Deque))) == NULL) {
     return NULL;
   }
   
   deque->count = 0;
   deque->is_empty = true;
   deque->_width = width;
+  deque->_allocator = allocator;
 
-  deque->_head = array_init(width);
-  deque->_tail = array_init(width);
+  deque->_head = array_init_with_allocator(width, allocator);
+  deque->_tail = array_init_with_allocator(width, allocator);
   
   if (deque->_head == NULL || deque->_tail == NULL) {
+    array_deinit(deque->_head);
+    array_deinit(deque->_tail);
+    allocator_deallocate(allocator, deque, sizeof(struct Deque));
     return NULL;
   }
   
@@ -91,30 +108,26 @@ void deque_deinit(struct Deque* deque) {
   array_deinit(deque->_head);
   array_deinit(deque->_tail);
   
-  free(deque);
+  allocator_deallocate(deque->_allocator, deque, sizeof(struct Deque));
 }
 
 /* MARK: - Accessing Elements */
 
 /* Returns the element at the specified position. */
 void deque_get(struct Deque* deque, Int64 index, void* element) {
+  memcpy(element, deque_at(deque, index), deque->_width);
+}
+
+void* deque_at(struct Deque* deque, Int64 index) {
   _deque_check_index(deque, index);
   
   /* Calculate real index */
   if (index >= deque->_head->count) { /* in tail */
     index -= deque->_head->count;
-    memcpy(
-      element,
-      deque->_tail->_storage + deque->_width * index,
-      deque->_width
-    );
+    return deque->_tail->_storage + deque->_width * index;
   } else { /* in head */
     index = deque->_head->count - 1 - index;
-    memcpy(
-      element,
-      deque->_head->_storage + deque->_width * index,
-      deque->_width
-    );
+    return deque->_head->_storage + deque->_width * index;
   }
 }
 //
@@ -238,6 +251,15 @@ void deque_remove_all(struct Deque* deque) {
   array_remove_all(deque->_tail);
 }
 
+void deque_set_shrink_policy(
+  struct Deque* deque,
+  enum ArrayShrinkPolicy policy,
+  Bool keeps_capacity
+) {
+  array_set_shrink_policy(deque->_head, policy, keeps_capacity);
+  array_set_shrink_policy(deque->_tail, policy, keeps_capacity);
+}
+
 /*===----------------------------------------------------------------------===*/
 /*             ___                            ___                             */
 /*           /'___\                          /\_ \    __                      */
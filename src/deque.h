@@ -50,6 +50,9 @@ struct Deque {
   /* The size of stored Element type. */
   UInt32 _width;
 
+  /* The source of the storage, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
+
   /**
    * A Boolean value indicating whether the deque is empty.
    *
@@ -59,6 +62,27 @@ struct Deque {
   Bool is_empty;
 };
 
+/*
+ * Returns a pointer to the element at `index` of `deque`.
+ *
+ * This is `deque_at()` in debug builds. When `NDEBUG` is defined it skips the
+ * bounds check. Arguments may be evaluated more than once.
+ */
+#ifdef NDEBUG
+#define DEQUE_AT(deque, index)                                                \
+  ((index) >= (deque)->_head->count                                           \
+    ? (void*)(                                                                \
+        (UInt8*)(deque)->_tail->_storage +                                    \
+        (Int64)(deque)->_width * ((index) - (deque)->_head->count)            \
+      )                                                                       \
+    : (void*)(                                                                \
+        (UInt8*)(deque)->_head->_storage +                                    \
+        (Int64)(deque)->_width * ((deque)->_head->count - 1 - (index))        \
+      ))
+#else
+#define DEQUE_AT(deque, index) deque_at((deque), (index))
+#endif
+
 /*----------------------------------------------------------------------------*/
 /**
  * Creates an empty deque.
@@ -73,6 +97,22 @@ struct Deque {
  */
 struct Deque* deque_init(UInt32 width);
 
+/**
+ * Creates an empty deque that takes its memory from a custom allocator.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *   - allocator: The allocator to use, which must outlive the deque. Pass NULL
+ *     to use the system allocator.
+ *
+ * - Returns: A pointer to the deque initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct Deque* deque_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+);
+
 /**
  * Destroys a deque.
  *
@@ -95,6 +135,14 @@ void deque_append(struct Deque* deque, void* new_element);
 /* Returns the element at the specified position. */
 void deque_get(struct Deque* deque, Int64 index, void* element);
 
+/**
+ * Returns a pointer to the element at the specified position.
+ *
+ * The element is accessed in place, without copying it. The pointer is valid
+ * until the next call that adds or removes elements.
+ */
+void* deque_at(struct Deque* deque, Int64 index);
+
 /**
  * Removes the first element of the deque.
  *
@@ -108,6 +156,18 @@ void deque_remove_first(struct Deque* deque);
  * Removes all elements from the deque.
  */
 void deque_remove_all(struct Deque* deque);
+
+/**
+ * Sets how the deque releases storage when elements are removed.
+ *
+ * The policy is applied to both halves of the deque. See
+ * `array_set_shrink_policy()`.
+ */
+void deque_set_shrink_policy(
+  struct Deque* deque,
+  enum ArrayShrinkPolicy policy,
+  Bool keeps_capacity
+);
 /*----------------------------------------------------------------------------*/
 
 #endif /* deque_h */
@@ -0,0 +1,170 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef deque_template_h
+#define deque_template_h
+
+#include "types.h"
+
+#include "array_template.h"
+#include "deque.h"
+
+/*
+ * Defines a deque specialized for one element type.
+ *
+ * `DEQUE_DEFINE(Name, prefix, Element)` emits `struct Name` and a set of
+ * `static` functions named `prefix_xxx` with the same semantics as the
+ * corresponding functions of `struct Deque`. The two halves of the deque are
+ * arrays generated by `ARRAY_DEFINE(Name##Half, prefix##_half, Element)`.
+ *
+ * Example:
+ *
+ *   DEQUE_DEFINE(Int64Deque, int64_deque, Int64)
+ *
+ *   var deque = int64_deque_init();
+ *   int64_deque_append(deque, 19358);
+ *   var first = int64_deque_get(deque, 0);
+ *   int64_deque_remove_first(deque);
+ *   int64_deque_deinit(deque);
+ *
+ * Emitted functions:
+ *   struct Name* prefix_init(void);
+ *   struct Name* prefix_init_with_allocator(const struct Allocator*);
+ *   void prefix_deinit(struct Name*);
+ *   void prefix_append(struct Name*, Element);
+ *   Element prefix_get(struct Name*, Int64 index);
+ *   Element* prefix_at(struct Name*, Int64 index);
+ *   void prefix_remove_first(struct Name*);
+ *   void prefix_remove_all(struct Name*);
+ */
+#define DEQUE_DEFINE(Name, prefix, Element)                                   \
+ARRAY_DEFINE(Name##Half, prefix##_half, Element)                              \
+                                                                              \
+struct Name {                                                                 \
+  /* See `struct Deque` for the layout of the two halves. */                  \
+  struct Name##Half* _head;                                                   \
+  struct Name##Half* _tail;                                                   \
+                                                                              \
+  /* The number of elements in the deque. */                                  \
+  Int64 count;                                                                \
+                                                                              \
+  /* A Boolean value indicating whether the deque is empty. */                \
+  Bool is_empty;                                                              \
+                                                                              \
+  /* The source of the storage, or NULL for the system allocator. */          \
+  const struct Allocator* _allocator;                                         \
+};                                                                            \
+                                                                              \
+/* Assumes that either the head or the tail is empty, but not both. */        \
+static void prefix##_rebalance(                                               \
+  struct Name##Half* empty,                                                   \
+  struct Name##Half* full                                                     \
+) {                                                                           \
+  var count = empty->count + full->count;                                     \
+  var half_count = count / 2;                                                 \
+  prefix##_half_reserve(empty, half_count);                                   \
+  var i = 0ll;                                                                \
+  for (i = 0; i < half_count; i += 1) { /* Important: copy backwords */       \
+    empty->_storage[i] = full->_storage[half_count - 1 - i];                  \
+  }                                                                           \
+  empty->count = half_count;                                                  \
+  empty->is_empty = half_count == 0;                                          \
+  memmove(                                                                    \
+    full->_storage,                                                           \
+    full->_storage + half_count,                                              \
+    (count - half_count) * sizeof(Element)                                    \
+  );                                                                          \
+  full->count = count - half_count;                                           \
+}                                                                             \
+                                                                              \
+static struct Name* prefix##_init_with_allocator(                             \
+  const struct Allocator* allocator                                           \
+) {                                                                           \
+  struct Name* deque;                                                         \
+  if ((deque = allocator_allocate(allocator, sizeof(struct Name))) == NULL) { \
+    return NULL;                                                              \
+  }                                                                           \
+  deque->count = 0;                                                           \
+  deque->is_empty = true;                                                     \
+  deque->_allocator = allocator;                                              \
+  deque->_head = prefix##_half_init_with_allocator(allocator);                \
+  deque->_tail = prefix##_half_init_with_allocator(allocator);                \
+  if (deque->_head == NULL || deque->_tail == NULL) {                         \
+    prefix##_half_deinit(deque->_head);                                       \
+    prefix##_half_deinit(deque->_tail);                                       \
+    allocator_deallocate(allocator, deque, sizeof(struct Name));              \
+    return NULL;                                                              \
+  }                                                                           \
+  return deque;                                                               \
+}                                                                             \
+                                                                              \
+static struct Name* prefix##_init(void) {                                     \
+  return prefix##_init_with_allocator(NULL);                                  \
+}                                                                             \
+                                                                              \
+static void prefix##_deinit(struct Name* deque) {                             \
+  if (deque == NULL) {                                                        \
+    return;                                                                   \
+  }                                                                           \
+  prefix##_half_deinit(deque->_head);                                         \
+  prefix##_half_deinit(deque->_tail);                                         \
+  allocator_deallocate(deque->_allocator, deque, sizeof(struct Name));        \
+}                                                                             \
+                                                                              \
+static void prefix##_append(struct Name* deque, Element new_element) {        \
+  deque->count += 1;                                                          \
+  deque->is_empty = false;                                                    \
+  prefix##_half_append(deque->_tail, new_element);                            \
+}                                                                             \
+                                                                              \
+static Element* prefix##_at(struct Name* deque, Int64 index) {                \
+  if (index >= deque->count || index < 0) {                                   \
+    fprintf(stderr, DEQUE_FATAL_ERR_OUTOB);                                   \
+    abort();                                                                  \
+  }                                                                           \
+  if (index >= deque->_head->count) { /* in tail */                           \
+    return deque->_tail->_storage + (index - deque->_head->count);            \
+  }                                                                           \
+  return deque->_head->_storage + (deque->_head->count - 1 - index);          \
+}                                                                             \
+                                                                              \
+static Element prefix##_get(struct Name* deque, Int64 index) {                \
+  return *prefix##_at(deque, index);                                          \
+}                                                                             \
+                                                                              \
+static void prefix##_remove_first(struct Name* deque) {                       \
+  if (deque->is_empty) {                                                      \
+    fprintf(stderr, DEQUE_FATAL_ERR_REMFT);                                   \
+    abort();                                                                  \
+  }                                                                           \
+  deque->count -= 1;                                                          \
+  if (deque->count == 0) {                                                    \
+    deque->is_empty = true;                                                   \
+    if (deque->_head->is_empty) {                                             \
+      prefix##_half_remove_last(deque->_tail);                                \
+    } else {                                                                  \
+      prefix##_half_remove_last(deque->_head);                                \
+    }                                                                         \
+    return;                                                                   \
+  }                                                                           \
+  if (deque->_head->is_empty) { /* rebalance needed */                        \
+    prefix##_rebalance(deque->_head, deque->_tail);                           \
+  }                                                                           \
+  prefix##_half_remove_last(deque->_head);                                    \
+}                                                                             \
+                                                                              \
+static void prefix##_remove_all(struct Name* deque) {                         \
+  deque->count = 0;                                                           \
+  deque->is_empty = true;                                                     \
+  prefix##_half_remove_all(deque->_head);                                     \
+  prefix##_half_remove_all(deque->_tail);                                     \
+}
+
+#endif /* deque_template_h */
@@ -0,0 +1,88 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* Parallel START                                       /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "parallel.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* What a new thread needs to run one task. */
+struct _ParallelThread {
+  pthread_t thread;
+  void* task;
+  void (*kernel)(void* task);
+};
+
+static void* _parallel_thread_main(void* argument) {
+  struct _ParallelThread* thread = argument;
+  thread->kernel(thread->task);
+  return NULL;
+}
+
+Int64 parallel_thread_count(Int64 thread_count, Int64 max_thread_count) {
+  if (thread_count <= 0) {
+    thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (thread_count > max_thread_count) {
+    thread_count = max_thread_count;
+  }
+  return thread_count < 1 ? 1 : thread_count;
+}
+
+void parallel_run(
+  void* tasks,
+  size_t task_size,
+  Int64 task_count,
+  void (*kernel)(void* task)
+) {
+  struct _ParallelThread threads[PARALLEL_MAX_THREAD_COUNT];
+  Bool is_started[PARALLEL_MAX_THREAD_COUNT] = {0};
+  var i = 0ll;
+  for (i = 1; i < task_count; i += 1) {
+    threads[i].task = (char*)tasks + i * task_size;
+    threads[i].kernel = kernel;
+    is_started[i] = pthread_create(
+      &threads[i].thread,
+      NULL,
+      _parallel_thread_main,
+      &threads[i]
+    ) == 0;
+  }
+  kernel(tasks);
+  for (i = 1; i < task_count; i += 1) {
+    if (is_started[i]) {
+      pthread_join(threads[i].thread, NULL);
+    } else {
+      kernel(threads[i].task);
+    }
+  }
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* Parallel END                        /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
@@ -0,0 +1,57 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef parallel_h
+#define parallel_h
+
+#include "types.h"
+
+#include <stddef.h> /* For size_t */
+
+/* The largest number of tasks `parallel_run()` runs at once. */
+#define PARALLEL_MAX_THREAD_COUNT 64
+
+/*
+ * The thread pool-free helpers behind the parallel reductions and
+ * `sort_parallel()`: every call starts its threads and joins them before
+ * returning.
+ */
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Returns the number of threads to use for a requested `thread_count`.
+ *
+ * A `thread_count` of 0 or less asks for one thread per online processor. The
+ * result is at least 1 and at most `max_thread_count`.
+ */
+Int64 parallel_thread_count(Int64 thread_count, Int64 max_thread_count);
+
+/**
+ * Calls `kernel` on each of `task_count` tasks, concurrently, and returns once
+ * all of them have finished.
+ *
+ * The first task runs on the calling thread and the others on new threads. A
+ * task whose thread can't be created runs on the calling thread afterwards, so
+ * the outcome never depends on thread creation succeeding.
+ *
+ * - Parameters:
+ *   - tasks: The first of `task_count` tasks, each `task_size` bytes.
+ *   - task_count: The number of tasks, at most `PARALLEL_MAX_THREAD_COUNT`.
+ *   - kernel: The function to call with a pointer to each task.
+ */
+void parallel_run(
+  void* tasks,
+  size_t task_size,
+  Int64 task_count,
+  void (*kernel)(void* task)
+);
+/*----------------------------------------------------------------------------*/
+
+#endif /* parallel_h */
@@ -21,8 +21,8 @@
 #include "red_black_tree.h"
 
 static struct RedBlackTreeNode* _red_black_tree_node_init(
+  struct RedBlackTree* tree,
   const void* key,
-  UInt32 element_size,
   Int64 size,
   Int64 count,
   struct RedBlackTreeNode* left,
@@ -30,7 +30,14 @@ static struct RedBlackTreeNode* _red_black_tree_node_init(
   struct RedBlackTreeNode* p,
   enum RedBlackTreeColor color
 ) {
-  var node = (struct RedBlackTreeNode*)malloc(sizeof(struct RedBlackTreeNode));
+  var node = (struct RedBlackTreeNode*)allocator_allocate(
+    tree->_allocator,
+    sizeof(struct RedBlackTreeNode)
+  );
+  if (node == NULL) {
+    fprintf(stderr, RBT_FATAL_ERR_MALLOC);
+    abort();
+  }
   
   node->children[0] = left;
   node->children[1] = right;
@@ -39,17 +46,29 @@ static struct RedBlackTreeNode* _red_black_tree_node_init(
   node->count = count;
   node->size = size;
   
-  node->key = malloc(element_size); /* allocate space for key */
+  /* allocate space for key */
+  node->key = allocator_allocate(tree->_allocator, tree->_width);
+  if (node->key == NULL) {
+    fprintf(stderr, RBT_FATAL_ERR_MALLOC);
+    abort();
+  }
   if (key != NULL) {
-    memcpy(node->key, key, element_size);
+    memcpy(node->key, key, tree->_width);
   }
   
   return node;
 }
 
-static void _red_black_tree_node_deinit(struct RedBlackTreeNode* node) {
-  free(node->key);
-  free(node);
+static void _red_black_tree_node_deinit(
+  struct RedBlackTree* tree,
+  struct RedBlackTreeNode* node
+) {
+  allocator_deallocate(tree->_allocator, node->key, tree->_width);
+  allocator_deallocate(
+    tree->_allocator,
+    node,
+    sizeof(struct RedBlackTreeNode)
+  );
 }
 
 /* 
@@ -358,7 +377,7 @@ static void _red_black_tree_deinit(
   if (node != tree->null) {
     _red_black_tree_deinit(tree, node->children[0]);
     _red_black_tree_deinit(tree, node->children[1]);
-    _red_black_tree_node_deinit(node);
+    _red_black_tree_node_deinit(tree, node);
   }
 }
 
@@ -369,12 +388,29 @@ struct RedBlackTree* red_black_tree_init(
   UInt32 width,
   Bool allow_duplicates,
   Int32 (*compare)(const void* lhs, const void* rhs)
+) {
+  return red_black_tree_init_with_allocator(
+    width,
+    allow_duplicates,
+    compare,
+    NULL
+  );
+}
+
+/* Creates a new, empty tree whose nodes come from `allocator`. */
+struct RedBlackTree* red_black_tree_init_with_allocator(
+  UInt32 width,
+  Bool allow_duplicates,
+  Int32 (*compare)(const void* lhs, const void* rhs),
+  const struct Allocator* allocator
 ) {
   struct RedBlackTree* tree;
-  if ((tree = malloc(sizeof(struct RedBlackTree))) == NULL) {
+  var size = sizeof(struct RedBlackTree);
+  if ((tree = allocator_allocate(allocator, size)) == NULL) {
     return NULL;
   }
   
+  tree->_allocator = allocator;
   tree->_width = width;
   tree->count = 0;
   tree->is_empty = true;
@@ -382,8 +418,8 @@ struct RedBlackTree* red_black_tree_init(
   tree->compare = compare;
   
   tree->null = _red_black_tree_node_init(
+    tree,         /* tree */
     NULL,         /* key */
-    width,        /* width */
     0,            /* size */
     0,            /* count */
     NULL,         /* left */
@@ -400,9 +436,9 @@ struct RedBlackTree* red_black_tree_init(
 /* Destroys a RedBlackTree. (postorder tree traversal) */
 void red_black_tree_deinit(struct RedBlackTree* tree) {
   _red_black_tree_deinit(tree, tree->root);
-  _red_black_tree_node_deinit(tree->null);
+  _red_black_tree_node_deinit(tree, tree->null);
   
-  free(tree);
+  allocator_deallocate(tree->_allocator, tree, sizeof(struct RedBlackTree));
 }
 
 /* MARK: - Adding Elements */
@@ -416,8 +452,8 @@ void red_black_tree_insert(struct RedBlackTree* tree, const void* key) {
   var x = tree->root;
   var y = tree->null;
   var z = _red_black_tree_node_init(
+    tree,                 /* tree */
     key,                  /* key */
-    tree->_width,         /* width */
     1,                    /* size */
     1,                    /* count */
     tree->null,            /* left */
@@ -436,6 +472,7 @@ void red_black_tree_insert(struct RedBlackTree* tree, const void* key) {
         x->count += 1;
         tree->count += 1;
       }
+      _red_black_tree_node_deinit(tree, z);
       return;
     }
     x = x->children[(tree->compare(x->key, key) < 0) ? 1 : 0];
@@ -513,7 +550,7 @@ void red_black_tree_remove(struct RedBlackTree* tree, const void* key) {
     if (old_color == RBT_BLACK) {
       _red_black_tree_delete_fixup(tree, x);
     }
-    _red_black_tree_node_deinit(z);
+    _red_black_tree_node_deinit(tree, z);
     tree->count -= 1;
     tree->is_empty = tree->count == 0 ? true : false;
     return;
@@ -17,8 +17,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocator.h"
+
 #define RBT_FATAL_ERR_REMEM "Can't remove from an empty red black tree."
 #define RBT_FATAL_ERR_INDOB "Index out of range."
+#define RBT_FATAL_ERR_MALLOC "Can't allocate a red black tree node."
 
 enum RedBlackTreeColor {
   RBT_RED,
@@ -46,6 +49,9 @@ struct RedBlackTree {
   
   UInt32 _width;
   
+  /* The source of the nodes, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
+  
   /* The number of elements in the tree */
   Int64 count;
   
@@ -68,6 +74,13 @@ struct RedBlackTree* red_black_tree_init(
   Int32 (*compare)(const void* lhs, const void* rhs)
 );
 
+struct RedBlackTree* red_black_tree_init_with_allocator(
+  UInt32 width,
+  Bool allow_duplicates,
+  Int32 (*compare)(const void* lhs, const void* rhs),
+  const struct Allocator* allocator
+);
+
 void red_black_tree_deinit(struct RedBlackTree* tree);
 
 void red_black_tree_insert(struct RedBlackTree* tree, const void* key);
@@ -0,0 +1,546 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* Reduction START                                      /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "reduction.h"
+
+/*
+ * The kernels use the GCC/Clang vector extensions rather than intrinsics, so
+ * the same code becomes SSE2, AVX2 or NEON depending on the compiler target.
+ * Each vector is 32 bytes and every loop keeps two of them, which hides the
+ * latency of the adds and compares.
+ */
+typedef UInt64 _UInt64Vector __attribute__((vector_size(32)));
+typedef Int64 _Int64Vector __attribute__((vector_size(32)));
+typedef Int32 _Int32Vector __attribute__((vector_size(32)));
+typedef Double _DoubleVector __attribute__((vector_size(32)));
+typedef Int32 _Int32HalfVector __attribute__((vector_size(16)));
+
+/* Loads a vector from a possibly unaligned address. */
+#define _reduction_load(vector, address)                                      \
+  memcpy(&(vector), (address), sizeof(vector))
+
+/* Picks the lanes of `a` where `mask` is all ones, and of `b` elsewhere. */
+#define _reduction_select(Vector, Mask, mask, a, b)                           \
+  ((Vector)(((Mask)(a) & (mask)) | ((Mask)(b) & ~(mask))))
+
+static void _reduction_check(const struct Array* array, UInt32 width) {
+  if (array->_width != width) {
+    fprintf(stderr, REDUCTION_FATAL_ERR_WIDTH);
+    abort();
+  }
+}
+
+static void _reduction_check_nonempty(const struct Array* array, UInt32 width) {
+  _reduction_check(array, width);
+  if (array->is_empty) {
+    fprintf(stderr, REDUCTION_FATAL_ERR_EMPTY);
+    abort();
+  }
+}
+
+/* MARK: - Sum */
+
+/* Sums in unsigned arithmetic, which wraps around instead of overflowing. */
+static UInt64 _reduction_sum_int64(const Int64* base, Int64 count) {
+  _UInt64Vector sums = {0};
+  _UInt64Vector more_sums = {0};
+  var i = 0ll;
+  for (; i + 8 <= count; i += 8) {
+    _UInt64Vector x, y;
+    _reduction_load(x, base + i);
+    _reduction_load(y, base + i + 4);
+    sums += x;
+    more_sums += y;
+  }
+  sums += more_sums;
+  var sum = sums[0] + sums[1] + sums[2] + sums[3];
+  for (; i < count; i += 1) {
+    sum += (UInt64)base[i];
+  }
+  return sum;
+}
+
+/*
+ * Widens each half of a vector of Int32 to Int64 before adding, so the lanes
+ * can't overflow for any array that fits in memory.
+ */
+static Int64 _reduction_sum_int32(const Int32* base, Int64 count) {
+  _Int64Vector sums = {0};
+  _Int64Vector more_sums = {0};
+  var i = 0ll;
+  for (; i + 8 <= count; i += 8) {
+    _Int32HalfVector x, y;
+    _reduction_load(x, base + i);
+    _reduction_load(y, base + i + 4);
+    sums += __builtin_convertvector(x, _Int64Vector);
+    more_sums += __builtin_convertvector(y, _Int64Vector);
+  }
+  sums += more_sums;
+  var sum = sums[0] + sums[1] + sums[2] + sums[3];
+  for (; i < count; i += 1) {
+    sum += base[i];
+  }
+  return sum;
+}
+
+static Double _reduction_sum_double(const Double* base, Int64 count) {
+  _DoubleVector sums = {0};
+  _DoubleVector more_sums = {0};
+  var i = 0ll;
+  for (; i + 8 <= count; i += 8) {
+    _DoubleVector x, y;
+    _reduction_load(x, base + i);
+    _reduction_load(y, base + i + 4);
+    sums += x;
+    more_sums += y;
+  }
+  sums += more_sums;
+  var sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  for (; i < count; i += 1) {
+    sum += base[i];
+  }
+  return sum;
+}
+
+Int64 array_sum_int32(const struct Array* array) {
+  _reduction_check(array, sizeof(Int32));
+  return _reduction_sum_int32(array->_storage, array->count);
+}
+
+Int64 array_sum_int64(const struct Array* array) {
+  _reduction_check(array, sizeof(Int64));
+  return (Int64)_reduction_sum_int64(array->_storage, array->count);
+}
+
+Double array_sum_double(const struct Array* array) {
+  _reduction_check(array, sizeof(Double));
+  return _reduction_sum_double(array->_storage, array->count);
+}
+
+/* MARK: - Parallel Sum */
+
+/* One contiguous part of a parallel reduction. */
+struct _ReductionTask {
+  const void* base;
+  Int64 count;
+  void (*kernel)(struct _ReductionTask* task);
+  union {
+    Int64 int64;
+    UInt64 uint64;
+    Double double_;
+  } result;
+};
+
+static void _reduction_sum_int32_task(struct _ReductionTask* task) {
+  task->result.int64 = _reduction_sum_int32(task->base, task->count);
+}
+
+static void _reduction_sum_int64_task(struct _ReductionTask* task) {
+  task->result.uint64 = _reduction_sum_int64(task->base, task->count);
+}
+
+static void _reduction_sum_double_task(struct _ReductionTask* task) {
+  task->result.double_ = _reduction_sum_double(task->base, task->count);
+}
+
+static void _reduction_task_main(void* argument) {
+  struct _ReductionTask* task = argument;
+  task->kernel(task);
+}
+
+/*
+ * Splits the array into `tasks`, runs them with `parallel_run()` and returns
+ * the number of tasks once they have all finished. Small arrays get a single
+ * task.
+ */
+static Int64 _reduction_run_parallel(
+  const struct Array* array,
+  Int64 thread_count,
+  void (*kernel)(struct _ReductionTask* task),
+  struct _ReductionTask tasks[REDUCTION_MAX_THREAD_COUNT]
+) {
+  thread_count = parallel_thread_count(
+    thread_count,
+    REDUCTION_MAX_THREAD_COUNT
+  );
+  if (array->count < REDUCTION_PARALLEL_THRESHOLD) {
+    thread_count = 1;
+  }
+
+  var part = array->count / thread_count;
+  var i = 0ll;
+  for (i = 0; i < thread_count; i += 1) {
+    tasks[i].base = array->_storage + i * part * array->_width;
+    tasks[i].count = i == thread_count - 1 ? array->count - i * part : part;
+    tasks[i].kernel = kernel;
+  }
+  parallel_run(tasks, sizeof(*tasks), thread_count, _reduction_task_main);
+  return thread_count;
+}
+
+Int64 array_sum_int32_parallel(const struct Array* array, Int64 thread_count) {
+  _reduction_check(array, sizeof(Int32));
+  struct _ReductionTask tasks[REDUCTION_MAX_THREAD_COUNT];
+  var task_count = _reduction_run_parallel(
+    array,
+    thread_count,
+    _reduction_sum_int32_task,
+    tasks
+  );
+  var sum = 0ll;
+  var i = 0ll;
+  for (i = 0; i < task_count; i += 1) {
+    sum += tasks[i].result.int64;
+  }
+  return sum;
+}
+
+Int64 array_sum_int64_parallel(const struct Array* array, Int64 thread_count) {
+  _reduction_check(array, sizeof(Int64));
+  struct _ReductionTask tasks[REDUCTION_MAX_THREAD_COUNT];
+  var task_count = _reduction_run_parallel(
+    array,
+    thread_count,
+    _reduction_sum_int64_task,
+    tasks
+  );
+  var sum = 0ull;
+  var i = 0ll;
+  for (i = 0; i < task_count; i += 1) {
+    sum += tasks[i].result.uint64;
+  }
+  return (Int64)sum;
+}
+
+Double array_sum_double_parallel(
+  const struct Array* array,
+  Int64 thread_count
+) {
+  _reduction_check(array, sizeof(Double));
+  struct _ReductionTask tasks[REDUCTION_MAX_THREAD_COUNT];
+  var task_count = _reduction_run_parallel(
+    array,
+    thread_count,
+    _reduction_sum_double_task,
+    tasks
+  );
+  var sum = 0.0;
+  var i = 0ll;
+  for (i = 0; i < task_count; i += 1) {
+    sum += tasks[i].result.double_;
+  }
+  return sum;
+}
+
+/* MARK: - Minimum and Maximum */
+
+/*
+ * Defines `name(base, count, min, max)`, which keeps the lane-wise minimum
+ * and maximum in two vectors and folds the lanes and the tail in at the end.
+ * `count` must be positive.
+ */
+#define _REDUCTION_MIN_MAX(name, Element, Vector, Mask)                       \
+static void name(                                                             \
+  const Element* base,                                                        \
+  Int64 count,                                                                \
+  Element* min,                                                               \
+  Element* max                                                                \
+) {                                                                           \
+  var lanes = (Int64)(sizeof(Vector) / sizeof(Element));                      \
+  var minimum = base[0];                                                      \
+  var maximum = base[0];                                                      \
+  var i = 0ll;                                                                \
+  var lane = 0ll;                                                             \
+  if (count >= lanes) {                                                       \
+    Vector low, high;                                                         \
+    _reduction_load(low, base);                                               \
+    high = low;                                                               \
+    for (i = lanes; i + lanes <= count; i += lanes) {                         \
+      Vector x;                                                               \
+      _reduction_load(x, base + i);                                           \
+      low = _reduction_select(Vector, Mask, (Mask)(x < low), x, low);         \
+      high = _reduction_select(Vector, Mask, (Mask)(x > high), x, high);      \
+    }                                                                         \
+    for (lane = 0; lane < lanes; lane += 1) {                                 \
+      minimum = low[lane] < minimum ? low[lane] : minimum;                    \
+      maximum = high[lane] > maximum ? high[lane] : maximum;                  \
+    }                                                                         \
+  }                                                                           \
+  for (; i < count; i += 1) {                                                 \
+    minimum = base[i] < minimum ? base[i] : minimum;                          \
+    maximum = base[i] > maximum ? base[i] : maximum;                          \
+  }                                                                           \
+  *min = minimum;                                                             \
+  *max = maximum;                                                             \
+}
+
+_REDUCTION_MIN_MAX(_reduction_min_max_int32, Int32, _Int32Vector, _Int32Vector)
+_REDUCTION_MIN_MAX(_reduction_min_max_int64, Int64, _Int64Vector, _Int64Vector)
+_REDUCTION_MIN_MAX(
+  _reduction_min_max_double,
+  Double,
+  _DoubleVector,
+  _Int64Vector
+)
+
+void array_min_max_int32(const struct Array* array, Int32* min, Int32* max) {
+  _reduction_check_nonempty(array, sizeof(Int32));
+  _reduction_min_max_int32(array->_storage, array->count, min, max);
+}
+
+void array_min_max_int64(const struct Array* array, Int64* min, Int64* max) {
+  _reduction_check_nonempty(array, sizeof(Int64));
+  _reduction_min_max_int64(array->_storage, array->count, min, max);
+}
+
+void array_min_max_double(
+  const struct Array* array,
+  Double* min,
+  Double* max
+) {
+  _reduction_check_nonempty(array, sizeof(Double));
+  _reduction_min_max_double(array->_storage, array->count, min, max);
+}
+
+/* MARK: - Index of Minimum and Maximum */
+
+/*
+ * Defines `name(base, count)`, which returns the index of the first element
+ * that no other element is `IS_BETTER` than. Each lane remembers its best
+ * value and where it was seen; only strictly better values replace it, so
+ * every lane holds its first best index, and ties between lanes go to the
+ * smaller index. `count` must be positive.
+ */
+#define _REDUCTION_ARG_BEST(name, Element, Vector, Mask, IS_BETTER)           \
+static Int64 name(const Element* base, Int64 count) {                         \
+  var best = base[0];                                                         \
+  var best_index = 0ll;                                                       \
+  var i = 0ll;                                                                \
+  var lane = 0;                                                               \
+  if (count >= 4) {                                                           \
+    Vector bests;                                                             \
+    _reduction_load(bests, base);                                             \
+    _Int64Vector indices = {0, 1, 2, 3};                                      \
+    var best_indices = indices;                                               \
+    for (i = 4; i + 4 <= count; i += 4) {                                     \
+      Vector x;                                                               \
+      _reduction_load(x, base + i);                                           \
+      indices += 4;                                                           \
+      var is_better = (Mask)IS_BETTER(x, bests);                              \
+      bests = _reduction_select(Vector, Mask, is_better, x, bests);           \
+      best_indices = _reduction_select(                                       \
+        _Int64Vector,                                                         \
+        _Int64Vector,                                                         \
+        __builtin_convertvector(is_better, _Int64Vector),                     \
+        indices,                                                              \
+        best_indices                                                          \
+      );                                                                      \
+    }                                                                         \
+    best = bests[0];                                                          \
+    best_index = best_indices[0];                                             \
+    for (lane = 1; lane < 4; lane += 1) {                                     \
+      if (                                                                    \
+        IS_BETTER(bests[lane], best) ||                                       \
+        (bests[lane] == best && best_indices[lane] < best_index)              \
+      ) {                                                                     \
+        best = bests[lane];                                                   \
+        best_index = best_indices[lane];                                      \
+      }                                                                       \
+    }                                                                         \
+  }                                                                           \
+  for (; i < count; i += 1) {                                                 \
+    if (IS_BETTER(base[i], best)) {                                           \
+      best = base[i];                                                         \
+      best_index = i;                                                         \
+    }                                                                         \
+  }                                                                           \
+  return best_index;                                                          \
+}
+
+#define _reduction_is_less(a, b) ((a) < (b))
+#define _reduction_is_greater(a, b) ((a) > (b))
+
+_REDUCTION_ARG_BEST(
+  _reduction_argmin_int32,
+  Int32,
+  _Int32HalfVector,
+  _Int32HalfVector,
+  _reduction_is_less
+)
+_REDUCTION_ARG_BEST(
+  _reduction_argmax_int32,
+  Int32,
+  _Int32HalfVector,
+  _Int32HalfVector,
+  _reduction_is_greater
+)
+_REDUCTION_ARG_BEST(
+  _reduction_argmin_int64,
+  Int64,
+  _Int64Vector,
+  _Int64Vector,
+  _reduction_is_less
+)
+_REDUCTION_ARG_BEST(
+  _reduction_argmax_int64,
+  Int64,
+  _Int64Vector,
+  _Int64Vector,
+  _reduction_is_greater
+)
+_REDUCTION_ARG_BEST(
+  _reduction_argmin_double,
+  Double,
+  _DoubleVector,
+  _Int64Vector,
+  _reduction_is_less
+)
+_REDUCTION_ARG_BEST(
+  _reduction_argmax_double,
+  Double,
+  _DoubleVector,
+  _Int64Vector,
+  _reduction_is_greater
+)
+
+Int64 array_argmin_int32(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Int32));
+  return _reduction_argmin_int32(array->_storage, array->count);
+}
+
+Int64 array_argmax_int32(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Int32));
+  return _reduction_argmax_int32(array->_storage, array->count);
+}
+
+Int64 array_argmin_int64(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Int64));
+  return _reduction_argmin_int64(array->_storage, array->count);
+}
+
+Int64 array_argmax_int64(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Int64));
+  return _reduction_argmax_int64(array->_storage, array->count);
+}
+
+Int64 array_argmin_double(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Double));
+  return _reduction_argmin_double(array->_storage, array->count);
+}
+
+Int64 array_argmax_double(const struct Array* array) {
+  _reduction_check_nonempty(array, sizeof(Double));
+  return _reduction_argmax_double(array->_storage, array->count);
+}
+
+/* MARK: - Prefix Sum */
+
+/*
+ * Defines `name(base, count, is_exclusive)`, which scans four elements at a
+ * time: their partial sums don't depend on the running total, so the loop
+ * carried dependency is one add per four elements instead of one per element.
+ */
+#define _REDUCTION_PREFIX_SUM(name, Element)                                  \
+static void name(Element* base, Int64 count, Bool is_exclusive) {             \
+  var sum = (Element)0;                                                       \
+  var i = 0ll;                                                                \
+  for (; i + 4 <= count; i += 4) {                                            \
+    var a = base[i];                                                          \
+    var ab = a + base[i + 1];                                                 \
+    var abc = ab + base[i + 2];                                               \
+    var abcd = abc + base[i + 3];                                             \
+    if (is_exclusive) {                                                       \
+      base[i] = sum;                                                          \
+      base[i + 1] = sum + a;                                                  \
+      base[i + 2] = sum + ab;                                                 \
+      base[i + 3] = sum + abc;                                                \
+    } else {                                                                  \
+      base[i] = sum + a;                                                      \
+      base[i + 1] = sum + ab;                                                 \
+      base[i + 2] = sum + abc;                                                \
+      base[i + 3] = sum + abcd;                                               \
+    }                                                                         \
+    sum += abcd;                                                              \
+  }                                                                           \
+  for (; i < count; i += 1) {                                                 \
+    var element = base[i];                                                    \
+    base[i] = is_exclusive ? sum : sum + element;                             \
+    sum += element;                                                           \
+  }                                                                           \
+}
+
+/* Scans in unsigned arithmetic, which wraps around instead of overflowing. */
+_REDUCTION_PREFIX_SUM(_reduction_prefix_sum_int32, UInt32)
+_REDUCTION_PREFIX_SUM(_reduction_prefix_sum_int64, UInt64)
+_REDUCTION_PREFIX_SUM(_reduction_prefix_sum_double, Double)
+
+void array_inclusive_prefix_sum_int32(struct Array* array) {
+  _reduction_check(array, sizeof(Int32));
+  Int64 count = 0;
+  UInt32* storage = array_span(array, &count);
+  _reduction_prefix_sum_int32(storage, count, false);
+}
+
+void array_exclusive_prefix_sum_int32(struct Array* array) {
+  _reduction_check(array, sizeof(Int32));
+  Int64 count = 0;
+  UInt32* storage = array_span(array, &count);
+  _reduction_prefix_sum_int32(storage, count, true);
+}
+
+void array_inclusive_prefix_sum_int64(struct Array* array) {
+  _reduction_check(array, sizeof(Int64));
+  Int64 count = 0;
+  UInt64* storage = array_span(array, &count);
+  _reduction_prefix_sum_int64(storage, count, false);
+}
+
+void array_exclusive_prefix_sum_int64(struct Array* array) {
+  _reduction_check(array, sizeof(Int64));
+  Int64 count = 0;
+  UInt64* storage = array_span(array, &count);
+  _reduction_prefix_sum_int64(storage, count, true);
+}
+
+void array_inclusive_prefix_sum_double(struct Array* array) {
+  _reduction_check(array, sizeof(Double));
+  Int64 count = 0;
+  Double* storage = array_span(array, &count);
+  _reduction_prefix_sum_double(storage, count, false);
+}
+
+void array_exclusive_prefix_sum_double(struct Array* array) {
+  _reduction_check(array, sizeof(Double));
+  Int64 count = 0;
+  Double* storage = array_span(array, &count);
+  _reduction_prefix_sum_double(storage, count, true);
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* Reduction END                       /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
@@ -0,0 +1,191 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef reduction_h
+#define reduction_h
+
+#include "array.h"
+#include "parallel.h"
+#include "types.h"
+
+#define REDUCTION_FATAL_ERR_WIDTH "Element width doesn't match the reduction"
+#define REDUCTION_FATAL_ERR_EMPTY "Can't reduce an empty array"
+
+/*
+ * The number of elements below which the parallel reductions don't start any
+ * threads. Below this, thread start-up costs more than the scan itself.
+ */
+#define REDUCTION_PARALLEL_THRESHOLD (1ll << 18)
+
+/* The largest number of threads a parallel reduction starts. */
+#define REDUCTION_MAX_THREAD_COUNT PARALLEL_MAX_THREAD_COUNT
+
+/*
+ * Typed reductions over the elements of an Array.
+ *
+ * Each function reads `_storage` directly and aborts if the element width of
+ * the array doesn't match the element type of the function. The kernels keep
+ * several independent accumulators in vector registers, so they run at close
+ * to memory bandwidth. Floating-point results therefore depend on that
+ * summation order and may differ from a left-to-right loop in the last bits.
+ */
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Returns the sum of the elements of an Array of `Int32`, accumulated in 64
+ * bits.
+ */
+Int64 array_sum_int32(const struct Array* array);
+
+/**
+ * Returns the sum of the elements of an Array of `Int64`. The sum wraps around
+ * on overflow.
+ */
+Int64 array_sum_int64(const struct Array* array);
+
+/** Returns the sum of the elements of an Array of `Double`. */
+Double array_sum_double(const struct Array* array);
+
+/**
+ * Returns the sum of the elements of an Array of `Int32`, splitting the work
+ * across threads.
+ *
+ * Arrays with fewer than `REDUCTION_PARALLEL_THRESHOLD` elements are summed on
+ * the calling thread.
+ *
+ * - Parameters:
+ *   - thread_count: The number of threads to use, including the calling
+ *                   one, or 0 to use one per online processor. At most
+ *                   `REDUCTION_MAX_THREAD_COUNT` threads are used.
+ */
+Int64 array_sum_int32_parallel(const struct Array* array, Int64 thread_count);
+
+/**
+ * Returns the sum of the elements of an Array of `Int64`, splitting the work
+ * across threads. See `array_sum_int32_parallel()`.
+ */
+Int64 array_sum_int64_parallel(const struct Array* array, Int64 thread_count);
+
+/**
+ * Returns the sum of the elements of an Array of `Double`, splitting the work
+ * across threads. See `array_sum_int32_parallel()`.
+ *
+ * The result depends on `thread_count`, as each thread sums its own part.
+ */
+Double array_sum_double_parallel(
+  const struct Array* array,
+  Int64 thread_count
+);
+/*----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Finds the smallest and the largest elements of a nonempty Array of `Int32`.
+ *
+ * - Parameters:
+ *   - min: On return, the smallest element.
+ *   - max: On return, the largest element.
+ */
+void array_min_max_int32(const struct Array* array, Int32* min, Int32* max);
+
+/**
+ * Finds the smallest and the largest elements of a nonempty Array of `Int64`.
+ * See `array_min_max_int32()`.
+ */
+void array_min_max_int64(const struct Array* array, Int64* min, Int64* max);
+
+/**
+ * Finds the smallest and the largest elements of a nonempty Array of
+ * `Double`. See `array_min_max_int32()`.
+ *
+ * The results are unspecified if the array contains NaNs.
+ */
+void array_min_max_double(
+  const struct Array* array,
+  Double* min,
+  Double* max
+);
+
+/**
+ * Returns the index of the first smallest element of a nonempty Array of
+ * `Int32`.
+ */
+Int64 array_argmin_int32(const struct Array* array);
+
+/**
+ * Returns the index of the first largest element of a nonempty Array of
+ * `Int32`.
+ */
+Int64 array_argmax_int32(const struct Array* array);
+
+/**
+ * Returns the index of the first smallest element of a nonempty Array of
+ * `Int64`.
+ */
+Int64 array_argmin_int64(const struct Array* array);
+
+/**
+ * Returns the index of the first largest element of a nonempty Array of
+ * `Int64`.
+ */
+Int64 array_argmax_int64(const struct Array* array);
+
+/**
+ * Returns the index of the first smallest element of a nonempty Array of
+ * `Double`. The result is unspecified if the array contains NaNs.
+ */
+Int64 array_argmin_double(const struct Array* array);
+
+/**
+ * Returns the index of the first largest element of a nonempty Array of
+ * `Double`. The result is unspecified if the array contains NaNs.
+ */
+Int64 array_argmax_double(const struct Array* array);
+/*----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Replaces every element of an Array of `Int32` with the sum of the elements
+ * up to and including it. Sums wrap around on overflow.
+ */
+void array_inclusive_prefix_sum_int32(struct Array* array);
+
+/**
+ * Replaces every element of an Array of `Int32` with the sum of the elements
+ * before it, so the first element becomes 0. Sums wrap around on overflow.
+ */
+void array_exclusive_prefix_sum_int32(struct Array* array);
+
+/**
+ * Replaces every element of an Array of `Int64` with the sum of the elements
+ * up to and including it. Sums wrap around on overflow.
+ */
+void array_inclusive_prefix_sum_int64(struct Array* array);
+
+/**
+ * Replaces every element of an Array of `Int64` with the sum of the elements
+ * before it, so the first element becomes 0. Sums wrap around on overflow.
+ */
+void array_exclusive_prefix_sum_int64(struct Array* array);
+
+/**
+ * Replaces every element of an Array of `Double` with the sum of the elements
+ * up to and including it.
+ */
+void array_inclusive_prefix_sum_double(struct Array* array);
+
+/**
+ * Replaces every element of an Array of `Double` with the sum of the elements
+ * before it, so the first element becomes 0.
+ */
+void array_exclusive_prefix_sum_double(struct Array* array);
+/*----------------------------------------------------------------------------*/
+
+#endif /* reduction_h */
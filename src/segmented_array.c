@@ -0,0 +1,242 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* SegmentedArray START                                 /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "segmented_array.h"
+
+#define _SEGMENTED_ARRAY_SHIFT SEGMENTED_ARRAY_FIRST_BLOCK_SHIFT
+
+/* The number of elements in block `block`. */
+static Int64 _segmented_array_block_capacity(Int64 block) {
+  return 1ll << (_SEGMENTED_ARRAY_SHIFT + block);
+}
+
+/* The index of the first element of block `block`. */
+static Int64 _segmented_array_block_start(Int64 block) {
+  return (1ll << (_SEGMENTED_ARRAY_SHIFT + block)) -
+    (1ll << _SEGMENTED_ARRAY_SHIFT);
+}
+
+/*
+ * Returns the address of the element at `index`, which must be below the
+ * capacity.
+ *
+ * Shifting the index by the size of the first block makes block k cover
+ * exactly the numbers whose highest set bit is bit k + shift, so the block is
+ * found with one leading zero count and the offset by clearing that bit.
+ */
+static void* _segmented_array_address(
+  struct SegmentedArray* array,
+  Int64 index
+) {
+  var shifted = (UInt64)index + (1ull << _SEGMENTED_ARRAY_SHIFT);
+  var high_bit = 63 - __builtin_clzll(shifted);
+  var offset = shifted - (1ull << high_bit);
+  var block = array->_blocks[high_bit - _SEGMENTED_ARRAY_SHIFT];
+  return block + offset * array->_width;
+}
+
+/* Check that the specified `index` is valid, i.e. `0 ≤ index < count`. */
+static void _segmented_array_check_index(
+  struct SegmentedArray* array,
+  Int64 index
+) {
+  if (index >= array->count || index < 0) {
+    fprintf(stderr, SEGMENTED_ARRAY_FATAL_ERR_OUTOB);
+    abort();
+  }
+}
+
+/* Allocates the next block, aborting on failure. */
+static void _segmented_array_add_block(struct SegmentedArray* array) {
+  var block = array->_block_count;
+  var capacity = _segmented_array_block_capacity(block);
+  var storage = allocator_allocate(
+    array->_allocator,
+    (size_t)capacity * array->_width
+  );
+  if (storage == NULL) {
+    fprintf(stderr, SEGMENTED_ARRAY_FATAL_ERR_MALLOC);
+    abort();
+  }
+  array->_blocks[block] = storage;
+  array->_block_count += 1;
+  array->_capacity += capacity;
+}
+
+/* Frees the last block. */
+static void _segmented_array_remove_block(struct SegmentedArray* array) {
+  array->_block_count -= 1;
+  var block = array->_block_count;
+  var capacity = _segmented_array_block_capacity(block);
+  allocator_deallocate(
+    array->_allocator,
+    array->_blocks[block],
+    (size_t)capacity * array->_width
+  );
+  array->_blocks[block] = NULL;
+  array->_capacity -= capacity;
+}
+
+/* MARK: - Creating and Destroying a SegmentedArray */
+
+struct SegmentedArray* segmented_array_init(UInt32 width) {
+  return segmented_array_init_with_allocator(width, NULL);
+}
+
+struct SegmentedArray* segmented_array_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+) {
+  struct SegmentedArray* array;
+  array = allocator_allocate(allocator, sizeof(struct SegmentedArray));
+  if (array == NULL) {
+    return NULL;
+  }
+
+  memset(array->_blocks, 0, sizeof(array->_blocks));
+  array->_block_count = 0;
+  array->count = 0;
+  array->_capacity = 0;
+  array->_width = width;
+  array->_allocator = allocator;
+  array->is_empty = true;
+
+  return array;
+}
+
+void segmented_array_deinit(struct SegmentedArray* array) {
+  if (array == NULL) {
+    return;
+  }
+
+  while (array->_block_count > 0) {
+    _segmented_array_remove_block(array);
+  }
+  allocator_deallocate(
+    array->_allocator,
+    array,
+    sizeof(struct SegmentedArray)
+  );
+}
+
+/* MARK: - Adding Elements */
+
+void segmented_array_reserve(
+  struct SegmentedArray* array,
+  Int64 minimum_capacity
+) {
+  while (array->_capacity < minimum_capacity) {
+    _segmented_array_add_block(array);
+  }
+}
+
+void segmented_array_append(struct SegmentedArray* array, void* new_element) {
+  if (array->count == array->_capacity) {
+    _segmented_array_add_block(array);
+  }
+  memcpy(
+    _segmented_array_address(array, array->count),
+    new_element,
+    array->_width
+  );
+  array->count += 1;
+  array->is_empty = false;
+}
+
+/* MARK: - Removing Elements */
+
+void segmented_array_remove_last(struct SegmentedArray* array) {
+  if (array->is_empty) {
+    fprintf(stderr, SEGMENTED_ARRAY_FATAL_ERR_REMEM);
+    abort();
+  }
+
+  array->count -= 1;
+  array->is_empty = array->count == 0;
+
+  /* Keep one empty block as a spare, free the one after it. */
+  while (
+    array->_block_count >= 2 &&
+    array->count <= _segmented_array_block_start(array->_block_count - 2)
+  ) {
+    _segmented_array_remove_block(array);
+  }
+}
+
+void segmented_array_remove_all(struct SegmentedArray* array) {
+  while (array->_block_count > 0) {
+    _segmented_array_remove_block(array);
+  }
+  array->count = 0;
+  array->is_empty = true;
+}
+
+/* MARK: - Accessing Elements */
+
+void segmented_array_get(
+  struct SegmentedArray* array,
+  Int64 index,
+  void* element
+) {
+  memcpy(element, segmented_array_at(array, index), array->_width);
+}
+
+void segmented_array_set(
+  struct SegmentedArray* array,
+  Int64 index,
+  void* element
+) {
+  memcpy(segmented_array_at(array, index), element, array->_width);
+}
+
+void* segmented_array_at(struct SegmentedArray* array, Int64 index) {
+  _segmented_array_check_index(array, index);
+  return _segmented_array_address(array, index);
+}
+
+void* segmented_array_segment_at(
+  struct SegmentedArray* array,
+  Int64 index,
+  Int64* count
+) {
+  _segmented_array_check_index(array, index);
+
+  var shifted = (UInt64)index + (1ull << _SEGMENTED_ARRAY_SHIFT);
+  var high_bit = 63 - __builtin_clzll(shifted);
+  /* The block ends where the next power of two starts. */
+  var end = (Int64)(
+    (1ull << (high_bit + 1)) - (1ull << _SEGMENTED_ARRAY_SHIFT)
+  );
+  *count = (end < array->count ? end : array->count) - index;
+
+  return _segmented_array_address(array, index);
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* SegmentedArray END                  /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
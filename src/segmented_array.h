@@ -0,0 +1,198 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef segmented_array_h
+#define segmented_array_h
+
+#include "types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+#define SEGMENTED_ARRAY_FATAL_ERR_MALLOC                                      \
+  "Can't allocate a segmented array block"
+#define SEGMENTED_ARRAY_FATAL_ERR_REMEM                                       \
+  "Can't remove last element from an empty array"
+#define SEGMENTED_ARRAY_FATAL_ERR_OUTOB "Index out of range"
+
+/* The first block holds 2^SEGMENTED_ARRAY_FIRST_BLOCK_SHIFT elements. */
+#define SEGMENTED_ARRAY_FIRST_BLOCK_SHIFT 4
+
+/* Enough blocks to cover every index that fits in an Int64. */
+#define SEGMENTED_ARRAY_MAX_BLOCK_COUNT (64 - SEGMENTED_ARRAY_FIRST_BLOCK_SHIFT)
+
+/**
+ * An ordered, random-access collection whose elements never move.
+ *
+ * The elements are stored in blocks of 16, 32, 64, ... elements, and a fixed
+ * directory points to the blocks. Growing allocates one more block instead of
+ * reallocating, so appending never copies existing elements and a pointer to
+ * an element stays valid until that element is removed. The block and the
+ * offset of an index are computed from its leading zero count, so random
+ * access is O(1).
+ *
+ *   index:   0 ... 15 | 16 ... 47 | 48 ... 111 | ...
+ *   block:   0        | 1         | 2          | ...
+ */
+struct SegmentedArray {
+  /* The blocks; only the first `_block_count` entries are allocated. */
+  void* _blocks[SEGMENTED_ARRAY_MAX_BLOCK_COUNT];
+
+  /* The number of allocated blocks. */
+  Int64 _block_count;
+
+  /**
+   * The number of elements in the array.
+   */
+  Int64 count;
+
+  /* The number of elements the allocated blocks can hold. */
+  Int64 _capacity;
+
+  /* The size of stored Element type. */
+  UInt32 _width;
+
+  /* The source of the storage, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
+
+  /**
+   * A Boolean value indicating whether the array is empty.
+   *
+   * When you need to check whether your array is empty, use the `is_empty`
+   * property instead of checking that the `count` property is equal to zero.
+   */
+  Bool is_empty;
+};
+
+/*----------------------------------------------------------------------------*/
+/**
+ * Creates an empty segmented array.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct SegmentedArray* segmented_array_init(UInt32 width);
+
+/**
+ * Creates an empty segmented array that takes its memory from a custom
+ * allocator.
+ *
+ * - Parameters:
+ *   - width: The size of stored Element type.
+ *   - allocator: The allocator to use, which must outlive the array. Pass NULL
+ *     to use the system allocator.
+ *
+ * - Returns: A pointer to the array initialized to be empty is returned. If the
+ * allocation fails, it returns NULL.
+ */
+struct SegmentedArray* segmented_array_init_with_allocator(
+  UInt32 width,
+  const struct Allocator* allocator
+);
+
+/**
+ * Destroys a segmented array.
+ *
+ * `segmented_array_deinit()` frees the blocks of the array, and the structure
+ * itself. If `array` is a NULL pointer, no operation is performed.
+ */
+void segmented_array_deinit(struct SegmentedArray* array);
+
+/**
+ * Reserves enough blocks to store the specified number of elements.
+ *
+ * - Parameters:
+ *   - minimum_capacity: The requested number of elements to store.
+ */
+void segmented_array_reserve(
+  struct SegmentedArray* array,
+  Int64 minimum_capacity
+);
+
+/**
+ * Adds a new element at the end of the array.
+ *
+ * Existing elements are never moved, so pointers to them stay valid.
+ *
+ * - Parameters:
+ *   - new_element: The element to append to the array.
+ */
+void segmented_array_append(struct SegmentedArray* array, void* new_element);
+
+/**
+ * Removes the last element of the array.
+ *
+ * The array must not be empty. A block is freed only once the block before it
+ * is empty too, so alternating appends and removals at a block boundary don't
+ * allocate every time.
+ */
+void segmented_array_remove_last(struct SegmentedArray* array);
+
+/**
+ * Removes all elements from the array and frees its blocks.
+ */
+void segmented_array_remove_all(struct SegmentedArray* array);
+
+/* Returns the element at the specified position. */
+void segmented_array_get(
+  struct SegmentedArray* array,
+  Int64 index,
+  void* element
+);
+
+/* Replaces the element at the specified position. */
+void segmented_array_set(
+  struct SegmentedArray* array,
+  Int64 index,
+  void* element
+);
+
+/**
+ * Returns a pointer to the element at the specified position.
+ *
+ * The pointer stays valid until the element is removed.
+ */
+void* segmented_array_at(struct SegmentedArray* array, Int64 index);
+
+/**
+ * Returns a pointer to the element at the specified position, along with the
+ * number of elements stored contiguously from there.
+ *
+ * Use it to visit the elements block by block:
+ *
+ * ```c
+ * var i = 0ll;
+ * while (i < array->count) {
+ *   Int64 count;
+ *   Int64* run = segmented_array_segment_at(array, i, &count);
+ *   // run[0], ..., run[count - 1] are elements i, ..., i + count - 1
+ *   i += count;
+ * }
+ * ```
+ *
+ * - Parameters:
+ *   - index: The position of the first element.
+ *   - count: On return, the number of elements that follow contiguously,
+ *            including the one at `index`.
+ */
+void* segmented_array_segment_at(
+  struct SegmentedArray* array,
+  Int64 index,
+  Int64* count
+);
+/*----------------------------------------------------------------------------*/
+
+#endif /* segmented_array_h */
@@ -20,108 +20,1121 @@
 
 #include "sort.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include "sort_engine.h"
+#include "types.h"
+
 #define var __auto_type
 
-static int partition(
+/* The largest element that insertion sort saves on the stack. */
+#define _SORT_STACK_ELEMENT_SIZE 256
+
+/*
+ * Exchanges two elements of `width` bytes.
+ *
+ * Common widths are moved as whole 4, 8 or 16-byte words (the `memcpy()`s
+ * compile to plain loads and stores), and larger elements in 64-byte chunks
+ * through a buffer, instead of one byte at a time.
+ */
+static void _sort_swap(void* a, void* b, size_t width) {
+  switch (width) {
+    case 4: {
+      UInt32 t;
+      memcpy(&t, a, 4);
+      memcpy(a, b, 4);
+      memcpy(b, &t, 4);
+      return;
+    }
+    case 8: {
+      UInt64 t;
+      memcpy(&t, a, 8);
+      memcpy(a, b, 8);
+      memcpy(b, &t, 8);
+      return;
+    }
+    case 16: {
+      UInt64 t[2];
+      memcpy(t, a, 16);
+      memcpy(a, b, 16);
+      memcpy(b, t, 16);
+      return;
+    }
+    default:
+      break;
+  }
+  UInt8 chunk[64];
+  while (width > 0) {
+    var n = width < sizeof(chunk) ? width : sizeof(chunk);
+    memcpy(chunk, a, n);
+    memcpy(a, b, n);
+    memcpy(b, chunk, n);
+    a += n;
+    b += n;
+    width -= n;
+  }
+}
+
+/* What the introsort engine needs to sort `nel` elements of `width` bytes. */
+struct _SortContext {
+  void* base;
+  size_t width;
+  int (*compare)(const void*, const void*);
+  /* `width` bytes for the pivot, or the element insertion sort moves. */
+  void* saved;
+};
+
+#define _SORT_AT(c, i) ((c)->base + (c)->width * (i))
+
+/*
+ * The element operations of `SORT_ENGINE_DEFINE()`, through the comparator
+ * member `compare` of the context and `memcpy()` with the runtime width.
+ */
+#define _SORT_OPS_LESS(compare, c, i, j)                                      \
+  ((c)->compare(_SORT_AT(c, i), _SORT_AT(c, j)) < 0)
+#define _SORT_OPS_SWAP(compare, c, i, j)                                      \
+  _sort_swap(_SORT_AT(c, i), _SORT_AT(c, j), (c)->width)
+#define _SORT_OPS_SAVE(compare, c, i)                                         \
+  memcpy((c)->saved, _SORT_AT(c, i), (c)->width)
+#define _SORT_OPS_ORDER_SAVED(compare, c, i)                                  \
+  (c)->compare(_SORT_AT(c, i), (c)->saved)
+
+/*
+ * Sorts `low..<high` by insertion.
+ *
+ * Each element that is out of place is saved, the larger elements before it
+ * are shifted up with one `memmove()`, and the saved element is written once
+ * into the gap.
+ */
+static void _sort_introsort_insertion_sort(
+  struct _SortContext* c,
+  size_t low,
+  size_t high
+) {
+  var j = low + 1;
+  for (; j < high; j += 1) {
+    if (c->compare(_SORT_AT(c, j - 1), _SORT_AT(c, j)) <= 0) {
+      continue;
+    }
+    memcpy(c->saved, _SORT_AT(c, j), c->width);
+    var i = j - 1;
+    while (i > low && c->compare(_SORT_AT(c, i - 1), c->saved) > 0) {
+      i -= 1;
+    }
+    memmove(_SORT_AT(c, i + 1), _SORT_AT(c, i), c->width * (j - i));
+    memcpy(_SORT_AT(c, i), c->saved, c->width);
+  }
+}
+
+SORT_ENGINE_DEFINE(
+  static,
+  _sort_introsort,
+  struct _SortContext,
+  _SORT_OPS,
+  compare
+)
+
+/* Reverses `base[low..<high]` in place. */
+static void _sort_reverse(void* base, size_t width, size_t low, size_t high) {
+  while (high - low > 1) {
+    high -= 1;
+    _sort_swap(base + width * low, base + width * high, width);
+    low += 1;
+  }
+}
+
+/*
+ * Returns the length of the run at the start of `base`: the longest prefix
+ * that is either non-descending, or strictly descending (`*is_descending`).
+ * `nel` must be at least 2.
+ *
+ * Descending runs must be strict, so reversing one keeps the sort stable.
+ */
+static size_t _sort_leading_run(
   void* base,
   size_t width,
-  int p,
-  int r,
+  size_t nel,
+  int (*compare)(const void*, const void*),
+  Bool* is_descending
+) {
+  var i = (size_t)2;
+  *is_descending = compare(base + width, base) < 0;
+  if (*is_descending) {
+    for (; i < nel; i += 1) {
+      if (compare(base + width * i, base + width * (i - 1)) >= 0) {
+        break;
+      }
+    }
+  } else {
+    for (; i < nel; i += 1) {
+      if (compare(base + width * i, base + width * (i - 1)) < 0) {
+        break;
+      }
+    }
+  }
+  return i;
+}
+
+void sort(
+  void* base, 
+  size_t nel,
+  size_t width,
   int (*compare)(const void*, const void*)
 ) {
-  var x_ptr = base + width * r;
-  var i = p - 1;
-  var j = 0;
-  for (j = p; j < r; j += 1) {
-    if (compare(base + width * j, x_ptr) <= 0) {
-      i += 1;
-      SWAP(base + width * i, base + width * j, width);
+  if (nel <= 1 || width == 0) {
+    return;
+  }
+  /*
+   * Room for the element insertion sort holds while shifting the others, and
+   * for the pivot while partitioning.
+   */
+  UInt8 stack_scratch[_SORT_STACK_ELEMENT_SIZE];
+  void* scratch = stack_scratch;
+  if (width > sizeof(stack_scratch) && (scratch = malloc(width)) == NULL) {
+    fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+    abort();
+  }
+  
+  struct _SortContext context;
+  context.base = base;
+  context.width = width;
+  context.compare = compare;
+  context.saved = scratch;
+  _sort_introsort(&context, nel);
+  
+  if (scratch != stack_scratch) {
+    free(scratch);
+  }
+}
+
+/* MARK: - Radix Sort */
+
+static size_t _sort_key_size(enum SortKeyType key_type) {
+  switch (key_type) {
+    case SORT_KEY_INT32:
+    case SORT_KEY_UINT32:
+      return sizeof(UInt32);
+    default:
+      return sizeof(UInt64);
+  }
+}
+
+/*
+ * Returns the key at `address` as an unsigned integer that has the same order:
+ * signed integers get their sign bit flipped, and doubles get either their
+ * sign bit flipped (if positive) or all bits flipped (if negative).
+ */
+static UInt64 _sort_radix_key(const void* address, enum SortKeyType key_type) {
+  switch (key_type) {
+    case SORT_KEY_INT32:
+    case SORT_KEY_UINT32: {
+      UInt32 key;
+      memcpy(&key, address, sizeof(key));
+      return key_type == SORT_KEY_INT32 ? key ^ (1u << 31) : key;
+    }
+    case SORT_KEY_INT64:
+    case SORT_KEY_UINT64: {
+      UInt64 key;
+      memcpy(&key, address, sizeof(key));
+      return key_type == SORT_KEY_INT64 ? key ^ (1ull << 63) : key;
+    }
+    case SORT_KEY_DOUBLE: {
+      UInt64 key;
+      memcpy(&key, address, sizeof(key));
+      return key >> 63 ? ~key : key | (1ull << 63);
     }
   }
-  SWAP(base + width * (i + 1), base + width * r, width);
-  return i + 1;
+  return 0;
 }
 
-static int randomized_partition(
+/* Copies one element, with a constant size for the common widths. */
+static void _sort_copy(void* destination, const void* source, size_t width) {
+  switch (width) {
+    case 4:
+      memcpy(destination, source, 4);
+      break;
+    case 8:
+      memcpy(destination, source, 8);
+      break;
+    case 16:
+      memcpy(destination, source, 16);
+      break;
+    default:
+      memcpy(destination, source, width);
+  }
+}
+
+void radix_sort(
   void* base,
+  size_t nel,
   size_t width,
-  int p,
-  int r,
-  int (*compare)(const void*, const void*)
+  size_t key_offset,
+  enum SortKeyType key_type
 ) {
-  var i = p + random() % (r - p + 1);
-  SWAP(base + width * r, base + width * i, width);
-  return partition(base, width, p, r, compare);
+  var key_size = _sort_key_size(key_type);
+  if (key_offset > width || width - key_offset < key_size) {
+    fprintf(stderr, SORT_FATAL_ERR_KEY);
+    abort();
+  }
+  if (nel <= 1) {
+    return;
+  }
+  
+  /* One pass counts the bytes of every digit. */
+  size_t counts[sizeof(UInt64)][256] = {{0}};
+  var i = (size_t)0;
+  var digit = (size_t)0;
+  for (i = 0; i < nel; i += 1) {
+    var key = _sort_radix_key(base + width * i + key_offset, key_type);
+    for (digit = 0; digit < key_size; digit += 1) {
+      counts[digit][(key >> (8 * digit)) & 0xff] += 1;
+    }
+  }
+  
+  var first_key = _sort_radix_key(base + key_offset, key_type);
+  void* scratch = NULL;
+  var source = base;
+  void* destination = NULL;
+  for (digit = 0; digit < key_size; digit += 1) {
+    /* A digit that is the same in every key doesn't change the order. */
+    if (counts[digit][(first_key >> (8 * digit)) & 0xff] == nel) {
+      continue;
+    }
+    if (scratch == NULL) {
+      if ((scratch = malloc(nel * width)) == NULL) {
+        fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+        abort();
+      }
+      destination = scratch;
+    }
+    
+    size_t offsets[256];
+    var offset = (size_t)0;
+    var byte = 0;
+    for (byte = 0; byte < 256; byte += 1) {
+      offsets[byte] = offset;
+      offset += counts[digit][byte];
+    }
+    for (i = 0; i < nel; i += 1) {
+      var element = source + width * i;
+      var key = _sort_radix_key(element + key_offset, key_type);
+      var key_byte = (key >> (8 * digit)) & 0xff;
+      _sort_copy(destination + width * offsets[key_byte], element, width);
+      offsets[key_byte] += 1;
+    }
+    
+    var swap = source;
+    source = destination;
+    destination = swap;
+  }
+  
+  if (source != base) {
+    memcpy(base, source, nel * width);
+  }
+  free(scratch);
 }
 
-static void _wkq_insertion_sort( 
+/* MARK: - Stable Sort */
+
+/* How many wins in a row switch a merge from one-by-one to galloping. */
+#define _SORT_MIN_GALLOP 7
+
+/*
+ * The most pending runs. The merge invariants make each run longer than the
+ * two above it combined, so their lengths grow at least like the Fibonacci
+ * numbers, and 85 runs would hold more than 2^64 elements.
+ */
+#define _SORT_MAX_RUN_COUNT 85
+
+/* A sorted run of `base[start..<start + count]`. */
+struct _SortRun {
+  size_t start;
+  size_t count;
+};
+
+struct _SortMergeState {
+  void* base;
+  size_t width;
+  int (*compare)(const void*, const void*);
+  
+  /* The buffer for the smaller run of a merge, and whether it is ours. */
+  void* scratch;
+  size_t scratch_size;
+  Bool owns_scratch;
+  
+  /* The current threshold for galloping, adjusted as merges go. */
+  size_t min_gallop;
+  
+  /* The runs waiting to be merged, from bottom to top. */
+  struct _SortRun runs[_SORT_MAX_RUN_COUNT];
+  size_t run_count;
+};
+
+/* Makes sure the scratch buffer holds `count` elements. */
+static void _sort_reserve_scratch(struct _SortMergeState* state, size_t count) {
+  var size = count * state->width;
+  if (size <= state->scratch_size) {
+    return;
+  }
+  if (state->owns_scratch) {
+    free(state->scratch);
+  }
+  if ((state->scratch = malloc(size)) == NULL) {
+    fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+    abort();
+  }
+  state->scratch_size = size;
+  state->owns_scratch = true;
+}
+
+/*
+ * Returns the length of the runs `stable_sort()` extends short runs to: a
+ * number between 32 and 64 such that `nel / min_run` is a power of two, or
+ * slightly less than one, so the final merges are balanced.
+ */
+static size_t _sort_min_run(size_t nel) {
+  var remainder = (size_t)0;
+  while (nel >= 64) {
+    remainder |= nel & 1;
+    nel >>= 1;
+  }
+  return nel + remainder;
+}
+
+/*
+ * Sorts `base[low..<high]`, whose prefix `base[low..<start]` is already
+ * sorted, by binary insertion. `element` holds `width` bytes.
+ *
+ * Each element is inserted after all the ones equal to it, so the sort is
+ * stable, and takes O(log n) comparisons per element.
+ */
+static void _sort_binary_insertion_sort(
   void* base,
   size_t width,
-  int p,
-  int r,
+  size_t low,
+  size_t high,
+  size_t start,
+  int (*compare)(const void*, const void*),
+  void* element
+) {
+  for (; start < high; start += 1) {
+    memcpy(element, base + width * start, width);
+    var left = low;
+    var right = start;
+    while (left < right) {
+      var middle = left + (right - left) / 2;
+      if (compare(element, base + width * middle) < 0) {
+        right = middle;
+      } else {
+        left = middle + 1;
+      }
+    }
+    memmove(
+      base + width * (left + 1),
+      base + width * left,
+      width * (start - left)
+    );
+    memcpy(base + width * left, element, width);
+  }
+}
+
+/*
+ * Returns the position of `key` in the sorted `array`, before any elements
+ * equal to it: `array[k - 1] < key <= array[k]`.
+ *
+ * The search starts at `hint` and probes at distances 1, 3, 7, 15, ... before
+ * a binary search, so it takes O(log d) comparisons when the answer is `d`
+ * elements away from the hint.
+ */
+static size_t _sort_gallop_left(
+  const void* key,
+  const void* array,
+  size_t count,
+  size_t hint,
+  size_t width,
   int (*compare)(const void*, const void*)
 ) {
-  var j = p + 1;
-  for (; j <= r; j += 1) {
-    var i = j;
-    while (i > 0 && compare(base + width * (i - 1), base + width * i) > 0) {
-      SWAP(base + width * (i - 1), base + width * i, width);
-      i -= 1;
+  var last = (size_t)0;
+  var offset = (size_t)1;
+  size_t low;
+  size_t high;
+  if (compare(array + width * hint, key) < 0) {
+    /* array[hint + last] < key <= array[hint + offset] */
+    var max = count - hint;
+    while (
+      offset < max &&
+      compare(array + width * (hint + offset), key) < 0
+    ) {
+      last = offset;
+      offset = 2 * offset + 1;
+    }
+    if (offset > max) {
+      offset = max;
+    }
+    low = hint + last + 1;
+    high = hint + offset;
+  } else {
+    /* array[hint - offset] < key <= array[hint - last] */
+    var max = hint + 1;
+    while (
+      offset < max &&
+      compare(array + width * (hint - offset), key) >= 0
+    ) {
+      last = offset;
+      offset = 2 * offset + 1;
+    }
+    if (offset > max) {
+      offset = max;
     }
+    low = hint + 1 - offset;
+    high = hint - last;
   }
+  while (low < high) {
+    var middle = low + (high - low) / 2;
+    if (compare(array + width * middle, key) < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return high;
 }
 
-static void _wkq_quicksort(
-  void* base,
+/*
+ * Returns the position of `key` in the sorted `array`, after any elements
+ * equal to it: `array[k - 1] <= key < array[k]`. See `_sort_gallop_left()`.
+ */
+static size_t _sort_gallop_right(
+  const void* key,
+  const void* array,
+  size_t count,
+  size_t hint,
   size_t width,
-  int p,
-  int r,
   int (*compare)(const void*, const void*)
 ) {
-  if (p < r) {
-    var is_sorted = true;
-    var i = 0;
-    for (i = p + 1; i <= r; i += 1) {
-      if (compare(base + width * i, base + width * (i - 1)) < 0) {
-        is_sorted = false;
-        break;
+  var last = (size_t)0;
+  var offset = (size_t)1;
+  size_t low;
+  size_t high;
+  if (compare(key, array + width * hint) < 0) {
+    /* array[hint - offset] <= key < array[hint - last] */
+    var max = hint + 1;
+    while (
+      offset < max &&
+      compare(key, array + width * (hint - offset)) < 0
+    ) {
+      last = offset;
+      offset = 2 * offset + 1;
+    }
+    if (offset > max) {
+      offset = max;
+    }
+    low = hint + 1 - offset;
+    high = hint - last;
+  } else {
+    /* array[hint + last] <= key < array[hint + offset] */
+    var max = count - hint;
+    while (
+      offset < max &&
+      compare(key, array + width * (hint + offset)) >= 0
+    ) {
+      last = offset;
+      offset = 2 * offset + 1;
+    }
+    if (offset > max) {
+      offset = max;
+    }
+    low = hint + last + 1;
+    high = hint + offset;
+  }
+  while (low < high) {
+    var middle = low + (high - low) / 2;
+    if (compare(key, array + width * middle) < 0) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return high;
+}
+
+/*
+ * Merges the adjacent runs `a` (`a_count` elements) and `b` (`b_count`),
+ * where `a_count <= b_count`, the first element of `a` is greater than the
+ * first of `b`, and the last of `a` is greater than the last of `b`.
+ *
+ * `a` is moved to the scratch buffer and the merge fills the gap from the
+ * front. Once one run wins `min_gallop` times in a row, the merge gallops:
+ * it finds how many elements of that run come next with one search and moves
+ * them as a block, which makes merging runs with long stretches from the same
+ * side close to linear in the number of stretches.
+ */
+static void _sort_merge_low(
+  struct _SortMergeState* state,
+  void* a,
+  size_t a_count,
+  void* b,
+  size_t b_count
+) {
+  var width = state->width;
+  var compare = state->compare;
+  _sort_reserve_scratch(state, a_count);
+  memcpy(state->scratch, a, width * a_count);
+  var destination = a;
+  void* from_a = state->scratch;
+  var from_b = b;
+  
+  memcpy(destination, from_b, width);
+  destination += width;
+  from_b += width;
+  b_count -= 1;
+  if (b_count == 0) {
+    goto succeed;
+  }
+  if (a_count == 1) {
+    goto copy_b;
+  }
+  
+  var min_gallop = state->min_gallop;
+  while (true) {
+    /* One element at a time, until a run wins `min_gallop` times in a row. */
+    var a_wins = (size_t)0;
+    var b_wins = (size_t)0;
+    do {
+      if (compare(from_b, from_a) < 0) {
+        memcpy(destination, from_b, width);
+        destination += width;
+        from_b += width;
+        b_count -= 1;
+        b_wins += 1;
+        a_wins = 0;
+        if (b_count == 0) {
+          goto succeed;
+        }
+      } else {
+        memcpy(destination, from_a, width);
+        destination += width;
+        from_a += width;
+        a_count -= 1;
+        a_wins += 1;
+        b_wins = 0;
+        if (a_count == 1) {
+          goto copy_b;
+        }
+      }
+    } while (a_wins < min_gallop && b_wins < min_gallop);
+    
+    /* Gallop for as long as it pays, making it easier to start next time. */
+    min_gallop += 1;
+    do {
+      min_gallop -= min_gallop > 1;
+      state->min_gallop = min_gallop;
+      
+      a_wins = _sort_gallop_right(from_b, from_a, a_count, 0, width, compare);
+      if (a_wins > 0) {
+        memcpy(destination, from_a, width * a_wins);
+        destination += width * a_wins;
+        from_a += width * a_wins;
+        a_count -= a_wins;
+        /* a_count is only 0 if `compare` is inconsistent. */
+        if (a_count == 1) {
+          goto copy_b;
+        }
+        if (a_count == 0) {
+          goto succeed;
+        }
+      }
+      memcpy(destination, from_b, width);
+      destination += width;
+      from_b += width;
+      b_count -= 1;
+      if (b_count == 0) {
+        goto succeed;
+      }
+      
+      b_wins = _sort_gallop_left(from_a, from_b, b_count, 0, width, compare);
+      if (b_wins > 0) {
+        memmove(destination, from_b, width * b_wins);
+        destination += width * b_wins;
+        from_b += width * b_wins;
+        b_count -= b_wins;
+        if (b_count == 0) {
+          goto succeed;
+        }
       }
+      memcpy(destination, from_a, width);
+      destination += width;
+      from_a += width;
+      a_count -= 1;
+      if (a_count == 1) {
+        goto copy_b;
+      }
+    } while (a_wins >= _SORT_MIN_GALLOP || b_wins >= _SORT_MIN_GALLOP);
+    min_gallop += 1;
+    state->min_gallop = min_gallop;
+  }
+  
+succeed:
+  memcpy(destination, from_a, width * a_count);
+  return;
+copy_b:
+  /* The last element of `a` is the greatest of all. */
+  memmove(destination, from_b, width * b_count);
+  memcpy(destination + width * b_count, from_a, width);
+}
+
+/*
+ * Merges the adjacent runs `a` and `b` like `_sort_merge_low()`, where
+ * `a_count >= b_count`: `b` is moved to the scratch buffer and the merge
+ * fills the gap from the back.
+ */
+static void _sort_merge_high(
+  struct _SortMergeState* state,
+  void* a,
+  size_t a_count,
+  void* b,
+  size_t b_count
+) {
+  var width = state->width;
+  var compare = state->compare;
+  _sort_reserve_scratch(state, b_count);
+  memcpy(state->scratch, b, width * b_count);
+  /* Each points to the last element of its part. */
+  var destination = b + width * (b_count - 1);
+  var from_a = a + width * (a_count - 1);
+  void* from_b = state->scratch + width * (b_count - 1);
+  
+  memcpy(destination, from_a, width);
+  destination -= width;
+  from_a -= width;
+  a_count -= 1;
+  if (a_count == 0) {
+    goto succeed;
+  }
+  if (b_count == 1) {
+    goto copy_a;
+  }
+  
+  var min_gallop = state->min_gallop;
+  while (true) {
+    var a_wins = (size_t)0;
+    var b_wins = (size_t)0;
+    do {
+      if (compare(from_b, from_a) < 0) {
+        memcpy(destination, from_a, width);
+        destination -= width;
+        from_a -= width;
+        a_count -= 1;
+        a_wins += 1;
+        b_wins = 0;
+        if (a_count == 0) {
+          goto succeed;
+        }
+      } else {
+        memcpy(destination, from_b, width);
+        destination -= width;
+        from_b -= width;
+        b_count -= 1;
+        b_wins += 1;
+        a_wins = 0;
+        if (b_count == 1) {
+          goto copy_a;
+        }
+      }
+    } while (a_wins < min_gallop && b_wins < min_gallop);
+    
+    min_gallop += 1;
+    do {
+      min_gallop -= min_gallop > 1;
+      state->min_gallop = min_gallop;
+      
+      a_wins = a_count - _sort_gallop_right(
+        from_b,
+        a,
+        a_count,
+        a_count - 1,
+        width,
+        compare
+      );
+      if (a_wins > 0) {
+        destination -= width * a_wins;
+        from_a -= width * a_wins;
+        memmove(destination + width, from_a + width, width * a_wins);
+        a_count -= a_wins;
+        if (a_count == 0) {
+          goto succeed;
+        }
+      }
+      memcpy(destination, from_b, width);
+      destination -= width;
+      from_b -= width;
+      b_count -= 1;
+      if (b_count == 1) {
+        goto copy_a;
+      }
+      
+      b_wins = b_count - _sort_gallop_left(
+        from_a,
+        state->scratch,
+        b_count,
+        b_count - 1,
+        width,
+        compare
+      );
+      if (b_wins > 0) {
+        destination -= width * b_wins;
+        from_b -= width * b_wins;
+        memcpy(destination + width, from_b + width, width * b_wins);
+        b_count -= b_wins;
+        /* b_count is only 0 if `compare` is inconsistent. */
+        if (b_count == 1) {
+          goto copy_a;
+        }
+        if (b_count == 0) {
+          goto succeed;
+        }
+      }
+      memcpy(destination, from_a, width);
+      destination -= width;
+      from_a -= width;
+      a_count -= 1;
+      if (a_count == 0) {
+        goto succeed;
+      }
+    } while (a_wins >= _SORT_MIN_GALLOP || b_wins >= _SORT_MIN_GALLOP);
+    min_gallop += 1;
+    state->min_gallop = min_gallop;
+  }
+  
+succeed:
+  memcpy(a, state->scratch, width * b_count);
+  return;
+copy_a:
+  /* The first element of `b` is the smallest of all. */
+  destination -= width * a_count;
+  from_a -= width * a_count;
+  memmove(destination + width, from_a + width, width * a_count);
+  memcpy(destination, from_b, width);
+}
+
+/* Merges the pending runs `i` and `i + 1`. */
+static void _sort_merge_at(struct _SortMergeState* state, size_t i) {
+  var width = state->width;
+  var compare = state->compare;
+  var a = state->base + width * state->runs[i].start;
+  var a_count = state->runs[i].count;
+  var b = state->base + width * state->runs[i + 1].start;
+  var b_count = state->runs[i + 1].count;
+  
+  state->runs[i].count += b_count;
+  if (i + 3 == state->run_count) {
+    state->runs[i + 1] = state->runs[i + 2];
+  }
+  state->run_count -= 1;
+  
+  /*
+   * Elements of `a` not greater than the first of `b`, and elements of `b`
+   * not less than the last of `a`, are already in place.
+   */
+  var k = _sort_gallop_right(b, a, a_count, 0, width, compare);
+  a += width * k;
+  a_count -= k;
+  if (a_count == 0) {
+    return;
+  }
+  b_count = _sort_gallop_left(
+    a + width * (a_count - 1),
+    b,
+    b_count,
+    b_count - 1,
+    width,
+    compare
+  );
+  if (b_count == 0) {
+    return;
+  }
+  
+  if (a_count <= b_count) {
+    _sort_merge_low(state, a, a_count, b, b_count);
+  } else {
+    _sort_merge_high(state, a, a_count, b, b_count);
+  }
+}
+
+/*
+ * Merges pending runs until, from the top of the stack down, each run is
+ * longer than the next one and than the two next ones combined.
+ *
+ * This keeps merges between runs of similar length, and the stack short.
+ */
+static void _sort_merge_collapse(struct _SortMergeState* state) {
+  var runs = state->runs;
+  while (state->run_count > 1) {
+    var i = state->run_count - 2;
+    if (
+      (i > 0 && runs[i - 1].count <= runs[i].count + runs[i + 1].count) ||
+      (i > 1 && runs[i - 2].count <= runs[i - 1].count + runs[i].count)
+    ) {
+      if (runs[i - 1].count < runs[i + 1].count) {
+        i -= 1;
+      }
+    } else if (runs[i].count > runs[i + 1].count) {
+      return;
+    }
+    _sort_merge_at(state, i);
+  }
+}
+
+/* Merges all pending runs into one. */
+static void _sort_merge_force_collapse(struct _SortMergeState* state) {
+  var runs = state->runs;
+  while (state->run_count > 1) {
+    var i = state->run_count - 2;
+    if (i > 0 && runs[i - 1].count < runs[i + 1].count) {
+      i -= 1;
     }
+    _sort_merge_at(state, i);
+  }
+}
 
-    var is_reverse_sorted = true;
-    for (i = r; i > p; i -= 1) {
-      if (compare(base + width * i, base + width * (i - 1)) > 0) {
-        is_reverse_sorted = false;
+void stable_sort(
+  void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  void* scratch,
+  size_t scratch_size
+) {
+  if (nel <= 1 || width == 0) {
+    return;
+  }
+  
+  struct _SortMergeState state;
+  state.base = base;
+  state.width = width;
+  state.compare = compare;
+  state.scratch = scratch;
+  state.scratch_size = scratch == NULL ? 0 : scratch_size;
+  state.owns_scratch = false;
+  state.min_gallop = _SORT_MIN_GALLOP;
+  state.run_count = 0;
+  
+  /* Room for the element binary insertion sort is placing. */
+  UInt8 stack_element[_SORT_STACK_ELEMENT_SIZE];
+  void* element = stack_element;
+  if (width > sizeof(stack_element) && (element = malloc(width)) == NULL) {
+    fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+    abort();
+  }
+  
+  /*
+   * Find the next run, strictly descending ones reversed, extend it to
+   * `min_run` elements if it is shorter, and merge it with the pending runs
+   * as their invariants require.
+   */
+  var min_run = _sort_min_run(nel);
+  var low = (size_t)0;
+  while (low < nel) {
+    var count = (size_t)1;
+    if (nel - low > 1) {
+      Bool is_descending;
+      count = _sort_leading_run(
+        base + width * low,
+        width,
+        nel - low,
+        compare,
+        &is_descending
+      );
+      if (is_descending) {
+        _sort_reverse(base, width, low, low + count);
       }
     }
-    if (is_reverse_sorted) {
-      i = p;
-      var j = r;
-      while (j > i) {
-        SWAP(base + width * i, base + width * j, width);
-        i += 1;
+    if (count < min_run) {
+      var forced = nel - low < min_run ? nel - low : min_run;
+      _sort_binary_insertion_sort(
+        base,
+        width,
+        low,
+        low + forced,
+        low + count,
+        compare,
+        element
+      );
+      count = forced;
+    }
+    
+    state.runs[state.run_count].start = low;
+    state.runs[state.run_count].count = count;
+    state.run_count += 1;
+    _sort_merge_collapse(&state);
+    low += count;
+  }
+  _sort_merge_force_collapse(&state);
+  
+  if (state.owns_scratch) {
+    free(state.scratch);
+  }
+  if (element != stack_element) {
+    free(element);
+  }
+}
+
+/* MARK: - Indirect Sort */
+
+/* The length of the blocks insertion sort prepares for the first merges. */
+#define _SORT_INDIRECT_BLOCK 32
+
+/*
+ * Sorts `pointers` by the elements they point to, using `scratch` (room for
+ * `nel` pointers), and returns whichever of the two holds the result.
+ *
+ * It is a bottom-up merge sort, stable and free of global state, since each
+ * comparison sees the element pointers themselves. Pairs of blocks that are
+ * already in order are copied without merging.
+ */
+static const void** _sort_pointers(
+  const void** pointers,
+  const void** scratch,
+  size_t nel,
+  int (*compare)(const void*, const void*)
+) {
+  var low = (size_t)0;
+  for (low = 0; low < nel; low += _SORT_INDIRECT_BLOCK) {
+    var high = nel - low < _SORT_INDIRECT_BLOCK
+      ? nel
+      : low + _SORT_INDIRECT_BLOCK;
+    var i = low + 1;
+    for (i = low + 1; i < high; i += 1) {
+      var pointer = pointers[i];
+      var j = i;
+      while (j > low && compare(pointers[j - 1], pointer) > 0) {
+        pointers[j] = pointers[j - 1];
         j -= 1;
       }
-    } else if (!is_sorted) {
-      if (r - p + 1 <= INS_THR) {
-        _wkq_insertion_sort(base, width, p, r, compare);
+      pointers[j] = pointer;
+    }
+  }
+  
+  var run = (size_t)_SORT_INDIRECT_BLOCK;
+  for (run = _SORT_INDIRECT_BLOCK; run < nel; run *= 2) {
+    for (low = 0; low < nel; low += 2 * run) {
+      var middle = nel - low < run ? nel : low + run;
+      var high = nel - middle < run ? nel : middle + run;
+      var i = low;
+      var j = middle;
+      var k = low;
+      if (
+        middle < high &&
+        compare(pointers[middle], pointers[middle - 1]) < 0
+      ) {
+        while (i < middle && j < high) {
+          if (compare(pointers[j], pointers[i]) < 0) {
+            scratch[k] = pointers[j];
+            j += 1;
+          } else {
+            scratch[k] = pointers[i];
+            i += 1;
+          }
+          k += 1;
+        }
+      }
+      memcpy(scratch + k, pointers + i, (middle - i) * sizeof(void*));
+      k += middle - i;
+      memcpy(scratch + k, pointers + j, (high - j) * sizeof(void*));
+    }
+    var swap = pointers;
+    pointers = scratch;
+    scratch = swap;
+  }
+  return pointers;
+}
+
+/*
+ * Sorts pointers to the `nel` elements of `base`, and returns them. `*buffer`
+ * is set to the allocation to free once the pointers have been read.
+ */
+static const void** _sort_indirect(
+  const void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  const void*** buffer
+) {
+  if ((*buffer = malloc(2 * nel * sizeof(void*))) == NULL) {
+    fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+    abort();
+  }
+  var pointers = *buffer;
+  var i = (size_t)0;
+  for (i = 0; i < nel; i += 1) {
+    pointers[i] = base + width * i;
+  }
+  return _sort_pointers(pointers, pointers + nel, nel, compare);
+}
+
+/*
+ * Writes the indices that would sort `base` to `indices`, each
+ * `index_width` bytes: `sizeof(Int64)` or `sizeof(Int32)`.
+ */
+static void _sort_indices(
+  const void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  void* indices,
+  size_t index_width
+) {
+  var i = (size_t)0;
+  if (width == 0) {
+    for (i = 0; i < nel; i += 1) {
+      if (index_width == sizeof(Int64)) {
+        ((Int64*)indices)[i] = i;
       } else {
-        var q = randomized_partition(base, width, p, r, compare);
-        _wkq_quicksort(base, width, p, q - 1, compare);
-        _wkq_quicksort(base, width, q + 1, r, compare);
+        ((Int32*)indices)[i] = (Int32)i;
       }
     }
+    return;
   }
+  if (nel == 0) {
+    return;
+  }
+  
+  const void** buffer;
+  var pointers = _sort_indirect(base, nel, width, compare, &buffer);
+  for (i = 0; i < nel; i += 1) {
+    var offset = (size_t)((const UInt8*)pointers[i] - (const UInt8*)base);
+    if (index_width == sizeof(Int64)) {
+      ((Int64*)indices)[i] = (Int64)(offset / width);
+    } else {
+      ((Int32*)indices)[i] = (Int32)(offset / width);
+    }
+  }
+  free(buffer);
 }
 
-void sort(
-  void* base, 
+void sort_indices(
+  const void* base,
   size_t nel,
   size_t width,
-  int (*compare)(const void*, const void*)
+  int (*compare)(const void*, const void*),
+  Int64* indices
 ) {
-  srandom(1935819342);
-  _wkq_quicksort(base, width, (int)0, (int)nel - 1, compare);
+  _sort_indices(base, nel, width, compare, indices, sizeof(Int64));
+}
+
+void sort_indices_int32(
+  const void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  Int32* indices
+) {
+  if (nel > INT32_MAX) {
+    fprintf(stderr, SORT_FATAL_ERR_INDEX);
+    abort();
+  }
+  _sort_indices(base, nel, width, compare, indices, sizeof(Int32));
 }
 
 /*===----------------------------------------------------------------------===*/
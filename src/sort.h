@@ -16,9 +16,39 @@
 
 #include <stddef.h> /* For size_t */
 
+#include "types.h"
+
 #define INS_THR 64
 
-/* Byte-wise swap two items of size SIZE. */
+#define SORT_FATAL_ERR_MALLOC "malloc() return a NULL pointer, check errno"
+#define SORT_FATAL_ERR_KEY    "The key doesn't fit in the element"
+#define SORT_FATAL_ERR_INDEX  "Too many elements for Int32 indices"
+
+/* The fewest elements `sort_parallel()` hands to each thread. */
+#define SORT_PARALLEL_THRESHOLD (1ll << 16)
+
+/* The most threads `sort_parallel()` uses. */
+#define SORT_MAX_THREAD_COUNT 64
+
+/* The type of the key `radix_sort()` orders elements by. */
+enum SortKeyType {
+  SORT_KEY_INT32,
+  SORT_KEY_UINT32,
+  SORT_KEY_INT64,
+  SORT_KEY_UINT64,
+  /*
+   * IEEE-754 doubles, in the order of their value: -inf, negative numbers,
+   * -0.0, +0.0, positive numbers, +inf. NaNs with the sign bit set sort before
+   * -inf, the others after +inf.
+   */
+  SORT_KEY_DOUBLE
+};
+
+/*
+ * Byte-wise swap two items of size SIZE.
+ *
+ * `sort()` no longer uses it: it swaps whole words where the width allows.
+ */
 #define SWAP(a, b, size)      \
   do {                        \
     size_t __size = (size);   \
@@ -34,6 +64,16 @@
 /**
  * The `sort()` function is a modified partition-exchange sort, or quicksort.
  *
+ * It is an introsort: quicksort with random median-of-three pivots and
+ * three-way partitioning, insertion sort on small ranges, and a heapsort
+ * fallback that bounds the worst case at O(n log n). Input that is already
+ * sorted, or sorted in reverse, is detected in a single pass up front. The
+ * sort is not stable.
+ *
+ * `sort()` keeps no global state: the pivots are drawn from a generator local
+ * to each call and seeded the same way every time, so it can run on many
+ * threads at once and sorts equal inputs into the same order.
+ *
  * The `sort()` function sort an array of `nel` objects, the initial member of
  * which is pointed to by `base`.  The size of each object is specified by
  * `width`.
@@ -53,5 +93,121 @@ void sort(
   int (*compare)(const void*, const void*)
 );
 
+/**
+ * Sorts an array like `sort()`, splitting the work across threads.
+ *
+ * The array is cut into one chunk per thread, the chunks are sorted
+ * concurrently with `sort()`, and the sorted runs are then merged in pairs.
+ * Each merge is divided among several threads by binary search, so the last
+ * merge of two halves keeps every thread busy too. The merges use a buffer of
+ * `nel * width` bytes.
+ *
+ * Each thread gets at least `SORT_PARALLEL_THRESHOLD` elements, so smaller
+ * arrays are sorted on the calling thread by `sort()`. The sort is not stable,
+ * and `compare` is called from several threads at once.
+ *
+ * - Parameters:
+ *   - thread_count: The number of threads to use, including the calling
+ *                   one, or 0 to use one per online processor. At most
+ *                   `SORT_MAX_THREAD_COUNT` threads are used.
+ */
+void sort_parallel(
+  void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  Int64 thread_count
+);
+
+/**
+ * Sorts an array by a numeric key stored in each element, without comparing
+ * elements.
+ *
+ * It is an LSD radix sort over the bytes of the key. Signed integers and
+ * doubles are mapped to unsigned integers in the same order, one pass over the
+ * array counts the bytes of every digit, and each digit then takes one pass
+ * that moves the elements between the array and a buffer of `nel * width`
+ * bytes. Digits that are the same in every key are skipped, so small keys in
+ * a wide type cost fewer passes. The sort is stable and takes O(n) time.
+ *
+ * - Parameters:
+ *   - key_offset: The offset of the key within an element. The key is read
+ *                 with `memcpy()`, so it needn't be aligned.
+ *   - key_type: The type of the key.
+ */
+void radix_sort(
+  void* base,
+  size_t nel,
+  size_t width,
+  size_t key_offset,
+  enum SortKeyType key_type
+);
+
+/**
+ * Sorts an array like `sort()`, keeping elements that compare equal in their
+ * original order.
+ *
+ * It is an adaptive merge sort in the style of Timsort: the array is split
+ * into its natural ascending and strictly descending runs (the latter
+ * reversed), short runs are extended with binary insertion sort, and the runs
+ * are merged so that merges stay balanced. When one run keeps winning, a merge
+ * gallops, moving whole blocks found by exponential search. Sorted, reversed
+ * and nearly sorted input, and arrays made of a few sorted parts, take close
+ * to O(n) time; the worst case is O(n log n).
+ *
+ * - Parameters:
+ *   - scratch: A buffer for the merges, or NULL. A merge needs room for the
+ *              smaller of its two runs, so `nel / 2 * width` bytes are always
+ *              enough; if a merge needs more, a buffer is allocated for the
+ *              rest of the sort.
+ *   - scratch_size: The size of `scratch` in bytes.
+ */
+void stable_sort(
+  void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  void* scratch,
+  size_t scratch_size
+);
+
+/**
+ * Sorts the indices of an array's elements instead of the elements.
+ *
+ * On return, `indices[0]` is the index of the smallest element of `base`,
+ * `indices[1]` the index of the next one, and so on; elements that compare
+ * equal keep their original order. The elements themselves don't move, which
+ * makes it the cheaper choice for wide elements: sort the indices, then move
+ * each element once with `array_apply_permutation()`, or read the elements in
+ * order through the indices.
+ *
+ * It is a stable merge sort of pointers to the elements, so `compare` gets the
+ * elements as it would from `sort()`. It uses a buffer of `2 * nel` pointers.
+ *
+ * - Parameters:
+ *   - indices: The `nel` indices to write.
+ */
+void sort_indices(
+  const void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  Int64* indices
+);
+
+/**
+ * Sorts the indices of an array's elements into `Int32`s, which halves the
+ * size of the result. See `sort_indices()`.
+ *
+ * It aborts if `nel` is greater than `INT32_MAX`.
+ */
+void sort_indices_int32(
+  const void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  Int32* indices
+);
+
 #endif /* sort_h */
 
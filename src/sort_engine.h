@@ -0,0 +1,288 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef sort_engine_h
+#define sort_engine_h
+
+#include "types.h"
+
+#include <stddef.h> /* For size_t */
+
+#include "sort.h" /* For INS_THR */
+
+/* The seed of every sort, so results are reproducible. */
+#define SORT_ENGINE_RANDOM_SEED 1935819342ull
+
+/*
+ * The introsort behind both `sort()` and `SORT_DEFINE()`: quicksort with
+ * random median-of-three pivots and three-way partitioning, insertion sort
+ * for small ranges, a heapsort fallback and presorted input detected up front.
+ *
+ * `SORT_ENGINE_DEFINE(Storage, prefix, Context, OPS, ORDER)` emits
+ *
+ *   Storage void prefix(Context* c, size_t nel);
+ *
+ * and its helpers, `prefix_partition()` and so on, which sort the `nel`
+ * elements that `c` describes. `Storage` is the storage class of every
+ * function, such as `static`; `inline` would break `-ansi` builds. Elements
+ * are only ever touched by index, through these macros, whose first argument
+ * is `ORDER`:
+ *
+ *   OPS_LESS(ORDER, c, i, j)      Whether element `i` is ordered before `j`.
+ *   OPS_SWAP(ORDER, c, i, j)      Exchanges elements `i` and `j`.
+ *   OPS_SAVE(ORDER, c, i)         Copies element `i` aside as the pivot.
+ *   OPS_ORDER_SAVED(ORDER, c, i)  Less than, equal to or greater than 0 as
+ *                                 element `i` is ordered before, with or
+ *                                 after the pivot.
+ *
+ * Small ranges go to `prefix_insertion_sort(Context* c, size_t low, size_t
+ * high)`, which the instance defines before the engine: shifting elements is
+ * where a runtime width and a compile-time type differ the most.
+ */
+#define SORT_ENGINE_DEFINE(Storage, prefix, Context, OPS, ORDER)              \
+/*                                                                            \
+ * Returns the next number of a xorshift64* generator. Each sort keeps its    \
+ * own state on the stack, so concurrent sorts neither contend on nor perturb \
+ * global libc state, and each one picks the same pivots for the same input.  \
+ */                                                                           \
+Storage UInt64 prefix##_random(UInt64* state) {                               \
+  var x = *state;                                                             \
+  x ^= x >> 12;                                                               \
+  x ^= x << 25;                                                               \
+  x ^= x >> 27;                                                               \
+  *state = x;                                                                 \
+  return x * 0x2545f4914f6cdd1dull;                                           \
+}                                                                             \
+                                                                              \
+/* Moves the median of elements `a`, `b` and `d` to `a`. */                   \
+Storage void prefix##_move_median_to_front(                                   \
+  Context* c,                                                                 \
+  size_t a,                                                                   \
+  size_t b,                                                                   \
+  size_t d                                                                    \
+) {                                                                           \
+  var median = a;                                                             \
+  if (OPS##_LESS(ORDER, c, a, b)) {                                           \
+    if (OPS##_LESS(ORDER, c, b, d)) {                                         \
+      median = b;                                                             \
+    } else if (OPS##_LESS(ORDER, c, a, d)) {                                  \
+      median = d;                                                             \
+    }                                                                         \
+  } else if (OPS##_LESS(ORDER, c, a, d)) {                                    \
+    median = a;                                                               \
+  } else if (OPS##_LESS(ORDER, c, b, d)) {                                    \
+    median = d;                                                               \
+  } else {                                                                    \
+    median = b;                                                               \
+  }                                                                           \
+  if (median != a) {                                                          \
+    OPS##_SWAP(ORDER, c, a, median);                                          \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * Partitions `low..<high` three ways around a pivot: on return, `low..<*lt`  \
+ * is less than the pivot, `*lt..<*gt` equal to it and `*gt..<high` greater.  \
+ *                                                                            \
+ * The pivot is the median of three random elements, so neither sorted inputs \
+ * nor a fixed adversarial pattern select bad pivots reliably. Elements equal \
+ * to the pivot are gathered in the middle and never recursed into, so inputs \
+ * with many duplicate keys take linear time per distinct key instead of      \
+ * degrading to O(n^2).                                                       \
+ */                                                                           \
+Storage void prefix##_partition(                                              \
+  Context* c,                                                                 \
+  size_t low,                                                                 \
+  size_t high,                                                                \
+  UInt64* random_state,                                                       \
+  size_t* lt,                                                                 \
+  size_t* gt                                                                  \
+) {                                                                           \
+  var n = high - low;                                                         \
+  prefix##_move_median_to_front(                                              \
+    c,                                                                        \
+    low + prefix##_random(random_state) % n,                                  \
+    low + prefix##_random(random_state) % n,                                  \
+    low + prefix##_random(random_state) % n                                   \
+  );                                                                          \
+  /* The first of the three is moved to `low` too, where the pivot belongs. */\
+  OPS##_SAVE(ORDER, c, low);                                                  \
+                                                                              \
+  /*                                                                          \
+   *   low      l           i           g      high                           \
+   *   +--------+-----------+-----------+--------+                            \
+   *   |   <    |    ==     |     ?     |   >    |                            \
+   *   +--------+-----------+-----------+--------+                            \
+   */                                                                         \
+  var l = low;                                                                \
+  var i = low + 1;                                                            \
+  var g = high;                                                               \
+  while (i < g) {                                                             \
+    var order = OPS##_ORDER_SAVED(ORDER, c, i);                               \
+    if (order < 0) {                                                          \
+      OPS##_SWAP(ORDER, c, l, i);                                             \
+      l += 1;                                                                 \
+      i += 1;                                                                 \
+    } else if (order > 0) {                                                   \
+      g -= 1;                                                                 \
+      OPS##_SWAP(ORDER, c, i, g);                                             \
+    } else {                                                                  \
+      i += 1;                                                                 \
+    }                                                                         \
+  }                                                                           \
+  *lt = l;                                                                    \
+  *gt = g;                                                                    \
+}                                                                             \
+                                                                              \
+/* Restores the max-heap order of `low..<high` below `root`. */               \
+Storage void prefix##_sift_down(                                              \
+  Context* c,                                                                 \
+  size_t low,                                                                 \
+  size_t root,                                                                \
+  size_t high                                                                 \
+) {                                                                           \
+  while (true) {                                                              \
+    var child = low + 2 * (root - low) + 1;                                   \
+    if (child >= high) {                                                      \
+      return;                                                                 \
+    }                                                                         \
+    if (child + 1 < high && OPS##_LESS(ORDER, c, child, child + 1)) {         \
+      child += 1;                                                             \
+    }                                                                         \
+    if (!OPS##_LESS(ORDER, c, root, child)) {                                 \
+      return;                                                                 \
+    }                                                                         \
+    OPS##_SWAP(ORDER, c, root, child);                                        \
+    root = child;                                                             \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * Sorts `low..<high` by heapsort, which is O(n log n) for every input. This  \
+ * is the fallback once quicksort has recursed too deep.                      \
+ */                                                                           \
+Storage void prefix##_heapsort(Context* c, size_t low, size_t high) {         \
+  var i = low + (high - low) / 2;                                             \
+  while (i > low) {                                                           \
+    i -= 1;                                                                   \
+    prefix##_sift_down(c, low, i, high);                                      \
+  }                                                                           \
+  for (i = high - 1; i > low; i -= 1) {                                       \
+    OPS##_SWAP(ORDER, c, low, i);                                             \
+    prefix##_sift_down(c, low, low, i);                                       \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+/* Reverses `low..<high` in place. */                                         \
+Storage void prefix##_reverse(Context* c, size_t low, size_t high) {          \
+  while (high - low > 1) {                                                    \
+    high -= 1;                                                                \
+    OPS##_SWAP(ORDER, c, low, high);                                          \
+    low += 1;                                                                 \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * Returns whether the elements are sorted in non-descending order, or,       \
+ * setting `*is_reversed`, in non-ascending order. `nel` must be at least 2.  \
+ *                                                                            \
+ * Random input stops after a couple of comparisons, while presorted input is \
+ * recognized in one pass instead of being partitioned. Equal elements may    \
+ * appear anywhere in a reversed array, as the sort needn't be stable.        \
+ */                                                                           \
+Storage Bool prefix##_is_presorted(                                           \
+  Context* c,                                                                 \
+  size_t nel,                                                                 \
+  Bool* is_reversed                                                           \
+) {                                                                           \
+  var i = (size_t)1;                                                          \
+  while (i < nel && !OPS##_LESS(ORDER, c, i, i - 1)) {                        \
+    i += 1;                                                                   \
+  }                                                                           \
+  *is_reversed = false;                                                       \
+  if (i == nel) {                                                             \
+    return true;                                                              \
+  }                                                                           \
+                                                                              \
+  /* A non-ascending array can only start with a run of equal elements. */    \
+  if (i > 1 && OPS##_LESS(ORDER, c, 0, i - 1)) {                              \
+    return false;                                                             \
+  }                                                                           \
+  while (i < nel && !OPS##_LESS(ORDER, c, i - 1, i)) {                        \
+    i += 1;                                                                   \
+  }                                                                           \
+  *is_reversed = true;                                                        \
+  return i == nel;                                                            \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ * Sorts `low..<high` by introsort: quicksort with three-way partitioning,    \
+ * insertion sort for small ranges, and heapsort once `depth_limit` levels of \
+ * partitioning haven't finished the job.                                     \
+ *                                                                            \
+ * Only the smaller side of each partition is sorted recursively; the loop    \
+ * continues with the larger one, so the stack depth stays below log2(n).     \
+ */                                                                           \
+Storage void prefix##_quicksort(                                              \
+  Context* c,                                                                 \
+  size_t low,                                                                 \
+  size_t high,                                                                \
+  UInt64* random_state,                                                       \
+  Int32 depth_limit                                                           \
+) {                                                                           \
+  while (high - low > 1) {                                                    \
+    if (high - low <= INS_THR) {                                              \
+      prefix##_insertion_sort(c, low, high);                                  \
+      return;                                                                 \
+    }                                                                         \
+    if (depth_limit == 0) {                                                   \
+      prefix##_heapsort(c, low, high);                                        \
+      return;                                                                 \
+    }                                                                         \
+    depth_limit -= 1;                                                         \
+                                                                              \
+    size_t lt;                                                                \
+    size_t gt;                                                                \
+    prefix##_partition(c, low, high, random_state, &lt, &gt);                 \
+    if (lt - low < high - gt) {                                               \
+      prefix##_quicksort(c, low, lt, random_state, depth_limit);              \
+      low = gt;                                                               \
+    } else {                                                                  \
+      prefix##_quicksort(c, gt, high, random_state, depth_limit);             \
+      high = lt;                                                              \
+    }                                                                         \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+Storage void prefix(Context* c, size_t nel) {                                 \
+  if (nel <= 1) {                                                             \
+    return;                                                                   \
+  }                                                                           \
+                                                                              \
+  /* Sorted and reverse-sorted input is handled once, up front. */            \
+  Bool is_reversed;                                                           \
+  if (prefix##_is_presorted(c, nel, &is_reversed)) {                          \
+    if (is_reversed) {                                                        \
+      prefix##_reverse(c, 0, nel);                                            \
+    }                                                                         \
+    return;                                                                   \
+  }                                                                           \
+                                                                              \
+  /* 2 * floor(log2(nel)) levels before falling back to heapsort */           \
+  var depth_limit = 0;                                                        \
+  var n = nel;                                                                \
+  for (n = nel; n > 1; n /= 2) {                                              \
+    depth_limit += 2;                                                         \
+  }                                                                           \
+  UInt64 random_state = SORT_ENGINE_RANDOM_SEED;                              \
+  prefix##_quicksort(c, 0, nel, &random_state, depth_limit);                  \
+}
+
+#endif /* sort_engine_h */
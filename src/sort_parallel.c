@@ -0,0 +1,259 @@
+/*===----------------------------------------------------------------------===*/
+/*                                                        ___   ___           */
+/* Sort Parallel START                                  /'___\ /\_ \          */
+/*                                                     /\ \__/ \//\ \         */
+/* Author: Fang Ling (fangling@fangl.ing)              \ \ ,__\  \ \ \        */
+/* Version: 1.0                                         \ \ \_/__ \_\ \_  __  */
+/* Date: October 16, 2026                                \ \_\/\_\/\____\/\_\ */
+/*                                                        \/_/\/_/\/____/\/_/ */
+/*===----------------------------------------------------------------------===*/
+
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#include "sort.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "parallel.h"
+#include "types.h"
+
+/*
+ * One part of a parallel sort: either sorting a chunk of `base` in place, or
+ * writing the output elements `begin..<end` of the merge of runs `a` and `b`
+ * to `destination`.
+ */
+struct _SortTask {
+  void (*kernel)(struct _SortTask* task);
+  size_t width;
+  int (*compare)(const void*, const void*);
+  void* a;
+  size_t a_count;
+  const void* b;
+  size_t b_count;
+  void* destination;
+  size_t begin;
+  size_t end;
+};
+
+/*
+ * Returns how many elements of `a` are among the first `k` elements of the
+ * merge of `a` and `b`, where elements of `a` come first on ties.
+ *
+ * This lets each thread find its own slice of a merge by binary search, so
+ * one large merge is split evenly across all threads.
+ */
+static size_t _sort_merge_split(
+  const void* a,
+  size_t a_count,
+  const void* b,
+  size_t b_count,
+  size_t k,
+  size_t width,
+  int (*compare)(const void*, const void*)
+) {
+  var low = k > b_count ? k - b_count : 0;
+  var high = k < a_count ? k : a_count;
+  while (low < high) {
+    var i = low + (high - low) / 2;
+    var j = k - i;
+    if (j > 0 && compare(a + width * i, b + width * (j - 1)) <= 0) {
+      low = i + 1;
+    } else {
+      high = i;
+    }
+  }
+  return low;
+}
+
+/* Merges the sorted runs `a` and `b` into `destination`. */
+static void _sort_merge(
+  const void* a,
+  size_t a_count,
+  const void* b,
+  size_t b_count,
+  void* destination,
+  size_t width,
+  int (*compare)(const void*, const void*)
+) {
+  var a_end = a + width * a_count;
+  var b_end = b + width * b_count;
+  while (a < a_end && b < b_end) {
+    if (compare(b, a) < 0) {
+      memcpy(destination, b, width);
+      b += width;
+    } else {
+      memcpy(destination, a, width);
+      a += width;
+    }
+    destination += width;
+  }
+  memcpy(destination, a, a_end - a);
+  destination += a_end - a;
+  memcpy(destination, b, b_end - b);
+}
+
+static void _sort_sort_task(struct _SortTask* task) {
+  sort(task->a, task->a_count, task->width, task->compare);
+  if (task->destination != NULL) {
+    memcpy(task->destination, task->a, task->a_count * task->width);
+  }
+}
+
+static void _sort_merge_task(struct _SortTask* task) {
+  var a_begin = _sort_merge_split(
+    task->a,
+    task->a_count,
+    task->b,
+    task->b_count,
+    task->begin,
+    task->width,
+    task->compare
+  );
+  var a_end = _sort_merge_split(
+    task->a,
+    task->a_count,
+    task->b,
+    task->b_count,
+    task->end,
+    task->width,
+    task->compare
+  );
+  var b_begin = task->begin - a_begin;
+  var b_end = task->end - a_end;
+  _sort_merge(
+    task->a + task->width * a_begin,
+    a_end - a_begin,
+    task->b + task->width * b_begin,
+    b_end - b_begin,
+    task->destination + task->width * task->begin,
+    task->width,
+    task->compare
+  );
+}
+
+static void _sort_task_main(void* argument) {
+  struct _SortTask* task = argument;
+  task->kernel(task);
+}
+
+void sort_parallel(
+  void* base,
+  size_t nel,
+  size_t width,
+  int (*compare)(const void*, const void*),
+  Int64 thread_count
+) {
+  thread_count = parallel_thread_count(thread_count, SORT_MAX_THREAD_COUNT);
+  /* Every thread sorts at least SORT_PARALLEL_THRESHOLD elements. */
+  if ((size_t)thread_count > nel / SORT_PARALLEL_THRESHOLD) {
+    thread_count = nel / SORT_PARALLEL_THRESHOLD;
+  }
+  if (thread_count <= 1 || width == 0) {
+    sort(base, nel, width, compare);
+    return;
+  }
+  
+  void* scratch;
+  if ((scratch = malloc(nel * width)) == NULL) {
+    fprintf(stderr, SORT_FATAL_ERR_MALLOC);
+    abort();
+  }
+  
+  /*
+   * The runs are merged in pairs, back and forth between `base` and
+   * `scratch`. With an odd number of rounds the sorted runs are first copied
+   * to `scratch`, so the last round writes to `base`.
+   */
+  var round_count = 0;
+  var runs = thread_count;
+  for (runs = thread_count; runs > 1; runs = (runs + 1) / 2) {
+    round_count += 1;
+  }
+  void* source = round_count % 2 == 0 ? base : scratch;
+  void* destination = round_count % 2 == 0 ? scratch : base;
+  
+  /* Sort one run per thread. */
+  struct _SortTask tasks[SORT_MAX_THREAD_COUNT];
+  size_t bounds[SORT_MAX_THREAD_COUNT + 1];
+  var part = nel / thread_count;
+  var i = 0ll;
+  for (i = 0; i < thread_count; i += 1) {
+    bounds[i] = part * i;
+  }
+  bounds[thread_count] = nel;
+  for (i = 0; i < thread_count; i += 1) {
+    tasks[i].kernel = _sort_sort_task;
+    tasks[i].width = width;
+    tasks[i].compare = compare;
+    tasks[i].a = base + width * bounds[i];
+    tasks[i].a_count = bounds[i + 1] - bounds[i];
+    tasks[i].destination = source == base ? NULL : source + width * bounds[i];
+  }
+  parallel_run(tasks, sizeof(*tasks), thread_count, _sort_task_main);
+  
+  /*
+   * Merge pairs of runs until one is left. Each merge is split among
+   * `thread_count / pair_count` threads, so every round keeps all threads
+   * busy, including the last one, which merges two halves of the array.
+   */
+  var run_count = thread_count;
+  while (run_count > 1) {
+    var pair_count = (run_count + 1) / 2;
+    var part_count = thread_count / pair_count;
+    var task_count = 0ll;
+    var pair = 0ll;
+    for (pair = 0; pair < pair_count; pair += 1) {
+      var low = bounds[2 * pair];
+      var middle = bounds[2 * pair + 1];
+      var high = 2 * pair + 2 <= run_count ? bounds[2 * pair + 2] : middle;
+      var merge_part = (high - low) / part_count;
+      for (i = 0; i < part_count; i += 1) {
+        var task = &tasks[task_count];
+        task->kernel = _sort_merge_task;
+        task->width = width;
+        task->compare = compare;
+        task->a = source + width * low;
+        task->a_count = middle - low;
+        task->b = source + width * middle;
+        task->b_count = high - middle;
+        task->destination = destination + width * low;
+        task->begin = merge_part * i;
+        task->end = i == part_count - 1 ? high - low : merge_part * (i + 1);
+        task_count += 1;
+      }
+    }
+    parallel_run(tasks, sizeof(*tasks), task_count, _sort_task_main);
+    
+    for (pair = 0; pair < pair_count; pair += 1) {
+      bounds[pair] = bounds[2 * pair];
+    }
+    bounds[pair_count] = nel;
+    run_count = pair_count;
+    var swap = source;
+    source = destination;
+    destination = swap;
+  }
+  
+  free(scratch);
+}
+
+/*===----------------------------------------------------------------------===*/
+/*             ___                            ___                             */
+/*           /'___\                          /\_ \    __                      */
+/*          /\ \__/   __      ___      __    \//\ \  /\_\    ___      __      */
+/*          \ \ ,__\/'__`\  /' _ `\  /'_ `\    \ \ \ \/\ \ /' _ `\  /'_ `\    */
+/*           \ \ \_/\ \L\.\_/\ \/\ \/\ \L\ \    \_\ \_\ \ \/\ \/\ \/\ \L\ \   */
+/*            \ \_\\ \__/.\_\ \_\ \_\ \____ \   /\____\\ \_\ \_\ \_\ \____ \  */
+/*             \/_/ \/__/\/_/\/_/\/_/\/___L\ \  \/____/ \/_/\/_/\/_/\/___L\ \ */
+/* Sort Parallel END                   /\____/                        /\____/ */
+/*                                     \_/__/                         \_/__/  */
+/*===----------------------------------------------------------------------===*/
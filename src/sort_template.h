@@ -0,0 +1,130 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#ifndef sort_template_h
+#define sort_template_h
+
+#include "types.h"
+
+#include <stddef.h>
+
+#include "sort_engine.h"
+
+/* Orders elements with the built-in `<`, for integer and floating types. */
+#define SORT_LESS(a, b) ((a) < (b))
+
+/* The element operations of `SORT_ENGINE_DEFINE()` for `SORT_DEFINE()`. */
+#define _SORT_TEMPLATE_LESS(LESS, c, i, j) LESS((c)->base[i], (c)->base[j])
+#define _SORT_TEMPLATE_SWAP(LESS, c, i, j)                                    \
+  do {                                                                        \
+    var _swap = (c)->base[i];                                                 \
+    (c)->base[i] = (c)->base[j];                                              \
+    (c)->base[j] = _swap;                                                     \
+  } while (0)
+#define _SORT_TEMPLATE_SAVE(LESS, c, i) ((c)->saved = (c)->base[i])
+#define _SORT_TEMPLATE_ORDER_SAVED(LESS, c, i)                                \
+  (LESS((c)->base[i], (c)->saved) ? -1 : LESS((c)->saved, (c)->base[i]))
+
+/*
+ * Defines a sort specialized for one element type and one ordering.
+ *
+ * `SORT_DEFINE(prefix, Element, LESS)` emits `static` functions that run the
+ * introsort of `sort()`, instantiated from the same `SORT_ENGINE_DEFINE()`, on
+ * an array of `Element`. `LESS(a, b)` is the name
+ * of a macro, or function, that takes two elements by value and is true if
+ * `a` is ordered before `b`. Because the ordering is known at compile time,
+ * comparisons are inlined instead of going through a function pointer, and
+ * elements are moved with plain assignments instead of `memcpy()` calls with
+ * a runtime width.
+ *
+ * Example:
+ *
+ *   SORT_DEFINE(sort_int64, Int64, SORT_LESS)
+ *
+ *   #define BY_X(a, b) ((a).x < (b).x)
+ *   SORT_DEFINE(sort_points_by_x, struct Point, BY_X)
+ *
+ *   sort_int64(values, count);
+ *   if (sort_int64_binary_search(values, count, 19358)) { ... }
+ *
+ * Emitted functions:
+ *   void prefix(Element* base, size_t nel);
+ *   size_t prefix_lower_bound(const Element* base, size_t nel, Element key);
+ *   Bool prefix_binary_search(const Element* base, size_t nel, Element key);
+ *
+ * `prefix_lower_bound()` returns the first position in a sorted array whose
+ * element isn't ordered before `key`, or `nel` if there is none.
+ */
+#define SORT_DEFINE(prefix, Element, LESS)                                    \
+struct _##prefix##_sort_context {                                             \
+  Element* base;                                                              \
+  Element saved;                                                              \
+};                                                                            \
+                                                                              \
+static void prefix##_introsort_insertion_sort(                                \
+  struct _##prefix##_sort_context* c,                                         \
+  size_t low,                                                                 \
+  size_t high                                                                 \
+) {                                                                           \
+  var base = c->base;                                                         \
+  var j = low + 1;                                                            \
+  for (; j < high; j += 1) {                                                  \
+    Element element = base[j];                                                \
+    var i = j;                                                                \
+    while (i > low && LESS(element, base[i - 1])) {                           \
+      base[i] = base[i - 1];                                                  \
+      i -= 1;                                                                 \
+    }                                                                         \
+    base[i] = element;                                                        \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+SORT_ENGINE_DEFINE(                                                           \
+  static,                                                                     \
+  prefix##_introsort,                                                         \
+  struct _##prefix##_sort_context,                                            \
+  _SORT_TEMPLATE,                                                             \
+  LESS                                                                        \
+)                                                                             \
+                                                                              \
+static void prefix(Element* base, size_t nel) {                               \
+  struct _##prefix##_sort_context context;                                    \
+  context.base = base;                                                        \
+  prefix##_introsort(&context, nel);                                          \
+}                                                                             \
+                                                                              \
+static size_t prefix##_lower_bound(                                           \
+  const Element* base,                                                        \
+  size_t nel,                                                                 \
+  Element key                                                                 \
+) {                                                                           \
+  var low = (size_t)0;                                                        \
+  var high = nel;                                                             \
+  while (low < high) {                                                        \
+    var middle = low + (high - low) / 2;                                      \
+    if (LESS(base[middle], key)) {                                            \
+      low = middle + 1;                                                       \
+    } else {                                                                  \
+      high = middle;                                                          \
+    }                                                                         \
+  }                                                                           \
+  return low;                                                                 \
+}                                                                             \
+                                                                              \
+static Bool prefix##_binary_search(                                           \
+  const Element* base,                                                        \
+  size_t nel,                                                                 \
+  Element key                                                                 \
+) {                                                                           \
+  var i = prefix##_lower_bound(base, nel, key);                               \
+  return i < nel && !LESS(key, base[i]);                                      \
+}
+
+#endif /* sort_template_h */
@@ -29,13 +29,16 @@ static char const WKQ_UTF8_LEN[] = {
 static struct String* _string_init(
   UInt32* _utf8,
   Int32* _utf8_length,
-  Int64 count
+  Int64 count,
+  const struct Allocator* allocator
 ) {
   struct String* string;
-  if ((string = malloc(sizeof(struct String))) == NULL) {
+  var size = sizeof(struct String);
+  if ((string = allocator_allocate(allocator, size)) == NULL) {
     return NULL;
   }
   
+  string->_allocator = allocator;
   string->_utf8_capacity = count;
   string->count = count;
   
@@ -44,8 +47,14 @@ static struct String* _string_init(
     string->is_empty = false;
   }
   
-  string->_utf8 = malloc(sizeof(UInt32) * string->_utf8_capacity);
-  string->_utf8_length = malloc(sizeof(Int32) * string->_utf8_capacity);
+  string->_utf8 = allocator_allocate(
+    allocator,
+    sizeof(UInt32) * string->_utf8_capacity
+  );
+  string->_utf8_length = allocator_allocate(
+    allocator,
+    sizeof(Int32) * string->_utf8_capacity
+  );
   
   memcpy(string->_utf8, _utf8, sizeof(UInt32) * count);
   memcpy(string->_utf8_length, _utf8_length, sizeof(Int32) * count);
@@ -183,10 +192,19 @@ noconv:
 /* MARK: - Creating and Destroying a String */
 
 struct String* string_init(const char* s) {
+  return string_init_with_allocator(s, NULL);
+}
+
+struct String* string_init_with_allocator(
+  const char* s,
+  const struct Allocator* allocator
+) {
   struct String* string;
-  if ((string = malloc(sizeof(struct String))) == NULL) {
+  var size = sizeof(struct String);
+  if ((string = allocator_allocate(allocator, size)) == NULL) {
     return NULL;
   }
+  string->_allocator = allocator;
   
   /* Calculate capacity & is_empty */
   string->is_empty = true;
@@ -200,8 +218,14 @@ struct String* string_init(const char* s) {
     string->is_empty = false;
   }
   
-  string->_utf8 = malloc(sizeof(UInt32) * string->_utf8_capacity);
-  string->_utf8_length = malloc(sizeof(UInt32) * string->_utf8_capacity);
+  string->_utf8 = allocator_allocate(
+    allocator,
+    sizeof(UInt32) * string->_utf8_capacity
+  );
+  string->_utf8_length = allocator_allocate(
+    allocator,
+    sizeof(Int32) * string->_utf8_capacity
+  );
   
   _s = s;
   string->count = 0;
@@ -221,9 +245,15 @@ struct String* string_init(const char* s) {
 }
 
 void string_deinit(struct String* string) {
-  free(string->_utf8);
-  free(string->_utf8_length);
-  free(string);
+  var allocator = string->_allocator;
+  var capacity = string->_utf8_capacity;
+  allocator_deallocate(allocator, string->_utf8, sizeof(UInt32) * capacity);
+  allocator_deallocate(
+    allocator,
+    string->_utf8_length,
+    sizeof(Int32) * capacity
+  );
+  allocator_deallocate(allocator, string, sizeof(struct String));
 }
 
 /* MARK: - Appending Strings and Characters */
@@ -273,7 +303,7 @@ struct String* string_substring(
   
   var _utf8 = string->_utf8 + start;
   var _utf8_length = string->_utf8_length + start;
-  return _string_init(_utf8, _utf8_length, end - start);
+  return _string_init(_utf8, _utf8_length, end - start, string->_allocator);
 }
 
 /* MARK: - Splitting a String */
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <ctype.h>
 
+#include "allocator.h"
 #include "array.h"
 
 struct String {
@@ -41,6 +42,9 @@ struct String {
   
   /* A Boolean value indicating whether a string has no characters. */
   Bool is_empty;
+  
+  /* The source of the storage, or NULL for the system allocator. */
+  const struct Allocator* _allocator;
 };
 
 /*----------------------------------------------------------------------------*/
@@ -50,6 +54,16 @@ struct String {
  */
 struct String* string_init(const char* s);
 
+/*
+ * Creates a string from a C-string, taking its memory from `allocator`.
+ * Substrings of the string are allocated from the same allocator. Pass NULL to
+ * use the system allocator.
+ */
+struct String* string_init_with_allocator(
+  const char* s,
+  const struct Allocator* allocator
+);
+
 /* Destroys a string. */
 void string_deinit(struct String* string);
 
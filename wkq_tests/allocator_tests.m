@@ -0,0 +1,161 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "allocator.h"
+#import "array.h"
+#import "deque.h"
+#import "red_black_tree.h"
+#import "string.h"
+
+#define var __auto_type
+
+struct Counter {
+  Int64 allocations;
+  Int64 bytes;
+};
+
+static void* counting_allocate(void* context, size_t size) {
+  struct Counter* counter = context;
+  counter->allocations += 1;
+  counter->bytes += size;
+  return malloc(size);
+}
+
+static void counting_deallocate(void* context, void* pointer, size_t size) {
+  struct Counter* counter = context;
+  counter->allocations -= 1;
+  counter->bytes -= size;
+  free(pointer);
+}
+
+@interface AllocatorTests : XCTestCase
+
+@end
+
+@implementation AllocatorTests
+
+- (void) test_array {
+  struct Counter counter = {0, 0};
+  struct Allocator allocator = {
+    counting_allocate,
+    NULL,
+    counting_deallocate,
+    &counter
+  };
+  
+  var array = array_init_with_allocator(sizeof(int), &allocator);
+  XCTAssertEqual(counter.allocations, 1);
+  for (var i = 0; i < 1000; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertEqual(counter.allocations, 2);
+  XCTAssertEqual(counter.bytes, sizeof(struct Array) + 1024 * sizeof(int));
+  for (var i = 0; i < 1000; i += 1) {
+    var delta = 0;
+    array_get(array, i, &delta);
+    XCTAssertEqual(delta, i);
+  }
+  array_deinit(array);
+  
+  XCTAssertEqual(counter.allocations, 0);
+  XCTAssertEqual(counter.bytes, 0);
+}
+
+- (void) test_deque {
+  struct Counter counter = {0, 0};
+  struct Allocator allocator = {
+    counting_allocate,
+    NULL,
+    counting_deallocate,
+    &counter
+  };
+  
+  var deque = deque_init_with_allocator(sizeof(int), &allocator);
+  for (var i = 0; i < 1000; i += 1) {
+    deque_append(deque, &i);
+  }
+  for (var i = 0; i < 500; i += 1) {
+    deque_remove_first(deque);
+  }
+  deque_deinit(deque);
+  
+  XCTAssertEqual(counter.allocations, 0);
+  XCTAssertEqual(counter.bytes, 0);
+}
+
+- (void) test_red_black_tree {
+  struct Counter counter = {0, 0};
+  struct Allocator allocator = {
+    counting_allocate,
+    NULL,
+    counting_deallocate,
+    &counter
+  };
+  
+  var tree = red_black_tree_init_with_allocator(
+    sizeof(int),
+    true,
+    compare,
+    &allocator
+  );
+  for (var i = 0; i < 1000; i += 1) {
+    var delta = i % 100;
+    red_black_tree_insert(tree, &delta);
+  }
+  XCTAssertEqual(tree->count, 1000);
+  for (var i = 0; i < 100; i += 1) {
+    red_black_tree_remove(tree, &i);
+  }
+  red_black_tree_deinit(tree);
+  
+  XCTAssertEqual(counter.allocations, 0);
+  XCTAssertEqual(counter.bytes, 0);
+}
+
+- (void) test_string {
+  struct Counter counter = {0, 0};
+  struct Allocator allocator = {
+    counting_allocate,
+    NULL,
+    counting_deallocate,
+    &counter
+  };
+  
+  var string = string_init_with_allocator("#zyy#abc#zyy#", &allocator);
+  var separator = string_init_with_allocator("#zyy#", &allocator);
+  var result = array_init_with_allocator(sizeof(struct String*), &allocator);
+  string_components(string, separator, result);
+  XCTAssertEqual(result->count, 3);
+  
+  for (var i = 0; i < result->count; i += 1) {
+    struct String* substring;
+    array_get(result, i, &substring);
+    string_deinit(substring);
+  }
+  array_deinit(result);
+  string_deinit(separator);
+  string_deinit(string);
+  
+  XCTAssertEqual(counter.allocations, 0);
+  XCTAssertEqual(counter.bytes, 0);
+}
+
+static int compare(const void* a, const void* b) {
+  if (*(int*)a > *(int*)b) {
+    return 1;
+  } else if (*(int*)a < *(int*)b) {
+    return -1;
+  }
+  return 0;
+}
+
+@end
@@ -10,11 +10,17 @@
 
 #import <XCTest/XCTest.h>
 
+#import <errno.h>
+#import <unistd.h>
+
 #import "array.h"
+#import "array_template.h"
 #import "string.h"
 
 #define var __auto_type
 
+ARRAY_DEFINE(Int64Array, int64_array, Int64)
+
 @interface ArrayTests : XCTestCase
 
 @end
@@ -45,7 +51,11 @@
   array_remove_last(array);
   XCTAssertTrue(array -> is_empty);
 
-  /* Add insert & remove_at test cases here */
+  array_insert(array, 0, &delta);
+  XCTAssertFalse(array->is_empty);
+  
+  array_remove_at(array, 0);
+  XCTAssertTrue(array->is_empty);
   
   array_deinit(array);
 }
@@ -59,7 +69,11 @@
   array_append(array, &delta);
   XCTAssertEqual(array->count, 1);
   
-  /* Add insert & remove_at test cases here */
+  array_insert(array, 0, &delta);
+  XCTAssertEqual(array->count, 2);
+  
+  array_remove_at(array, 1);
+  XCTAssertEqual(array->count, 1);
   
   array_remove_last(array);
   XCTAssertEqual(array->count, 0);
@@ -85,6 +99,430 @@
   array_deinit(array);
 }
 
+- (void) test_append_contents {
+  var array = array_init(sizeof(int));
+  
+  int input[1000];
+  for (var i = 0; i < 1000; i += 1) {
+    input[i] = i * 3;
+  }
+  array_append_contents(array, input, 0);
+  XCTAssertTrue(array->is_empty);
+  
+  array_append_contents(array, input, 1000);
+  XCTAssertEqual(array->count, 1000);
+  XCTAssertEqual(array->_capacity, 1024);
+  XCTAssertFalse(array->is_empty);
+  
+  array_append_contents(array, input, 5);
+  XCTAssertEqual(array->count, 1005);
+  
+  for (var i = 0; i < 1005; i += 1) {
+    var delta = 0;
+    array_get(array, i, &delta);
+    XCTAssertEqual(delta, input[i % 1000]);
+  }
+  
+  array_deinit(array);
+}
+
+- (void) test_combine {
+  var array = array_init(sizeof(int));
+  var other = array_init(sizeof(int));
+  
+  for (var i = 0; i < 100; i += 1) {
+    array_append(array, &i);
+    var delta = i + 100;
+    array_append(other, &delta);
+  }
+  array_combine(array, other);
+  XCTAssertEqual(array->count, 200);
+  
+  array_combine(array, array);
+  XCTAssertEqual(array->count, 400);
+  
+  for (var i = 0; i < 400; i += 1) {
+    var delta = 0;
+    array_get(array, i, &delta);
+    XCTAssertEqual(delta, i % 200);
+  }
+  
+  array_deinit(array);
+  array_deinit(other);
+}
+
+- (void) test_reserve {
+  var array = array_init_with_capacity(sizeof(int), 100);
+  XCTAssertEqual(array->_capacity, 100);
+  XCTAssertEqual(array->count, 0);
+  XCTAssertTrue(array->is_empty);
+  
+  for (var i = 0; i < 100; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertEqual(array->_capacity, 100);
+  
+  array_reserve(array, 50);
+  XCTAssertEqual(array->_capacity, 100);
+  array_reserve(array, 1000);
+  XCTAssertEqual(array->_capacity, 1000);
+  
+  array_shrink_to_fit(array);
+  XCTAssertEqual(array->_capacity, 100);
+  for (var i = 0; i < 100; i += 1) {
+    var delta = 0;
+    array_get(array, i, &delta);
+    XCTAssertEqual(delta, i);
+  }
+  
+  array_remove_all(array);
+  array_shrink_to_fit(array);
+  XCTAssertEqual(array->_capacity, 0);
+  
+  array_deinit(array);
+}
+
+- (void) test_shrink_policy {
+  var array = array_init(sizeof(int));
+  array_set_shrink_policy(array, ARRAY_SHRINK_POLICY_NEVER, true);
+  
+  for (var i = 0; i < 100; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertEqual(array->_capacity, 128);
+  while (!array->is_empty) {
+    array_remove_last(array);
+  }
+  XCTAssertEqual(array->_capacity, 128);
+  
+  array_append(array, &array->count);
+  array_remove_all(array);
+  XCTAssertEqual(array->_capacity, 128);
+  XCTAssertTrue(array->is_empty);
+  
+  array_set_shrink_policy(array, ARRAY_SHRINK_POLICY_HYSTERESIS, false);
+  for (var i = 0; i < 64; i += 1) {
+    array_append(array, &i);
+  }
+  while (array->count > 32) {
+    array_remove_last(array);
+  }
+  XCTAssertEqual(array->_capacity, 128);
+  while (array->count > 16) {
+    array_remove_last(array);
+  }
+  XCTAssertEqual(array->_capacity, 64);
+  
+  array_remove_all(array);
+  XCTAssertEqual(array->_capacity, 0);
+  
+  array_deinit(array);
+}
+
+- (void) test_replace_subrange {
+  var array = array_init(sizeof(int));
+  
+  int input[] = {1, 2, 3, 4, 5, 6, 7};
+  array_append_contents(array, input, 7);
+  
+  int replacement[] = {8, 9, 10};
+  array_replace_subrange(array, 2, 4, replacement, 3);
+  int expected_replace[] = {1, 2, 8, 9, 10, 5, 6, 7};
+  XCTAssertEqual(array->count, 8);
+  XCTAssertEqual(0, memcmp(array->_storage, expected_replace, sizeof(int) * 8));
+  
+  array_insert_contents(array, 0, input, 2);
+  array_insert_contents(array, array->count, input, 1);
+  int expected_insert[] = {1, 2, 1, 2, 8, 9, 10, 5, 6, 7, 1};
+  XCTAssertEqual(array->count, 11);
+  XCTAssertEqual(0, memcmp(array->_storage, expected_insert, sizeof(int) * 11));
+  
+  array_remove_subrange(array, 1, 9);
+  int expected_remove[] = {1, 7, 1};
+  XCTAssertEqual(array->count, 3);
+  XCTAssertEqual(0, memcmp(array->_storage, expected_remove, sizeof(int) * 3));
+  
+  array_remove_subrange(array, 0, array->count);
+  XCTAssertTrue(array->is_empty);
+  
+  array_deinit(array);
+}
+
+- (void) test_remove_all_where {
+  var array = array_init(sizeof(int));
+  
+  for (var i = 0; i < 100000; i += 1) {
+    array_append(array, &i);
+  }
+  var divisor = 2;
+  array_remove_all_where(array, is_multiple, &divisor);
+  XCTAssertEqual(array->count, 50000);
+  for (var i = 0; i < 50000; i += 1) {
+    XCTAssertEqual(*(int*)array_at(array, i), 2 * i + 1);
+  }
+  XCTAssertEqual(array->_capacity, 131072);
+  
+  divisor = 1;
+  array_remove_all_where(array, is_multiple, &divisor);
+  XCTAssertTrue(array->is_empty);
+  XCTAssertEqual(array->_capacity, 0);
+  
+  array_deinit(array);
+}
+
+- (void) test_at {
+  var array = array_init(sizeof(Int64));
+  
+  for (var i = 0ll; i < 100; i += 1) {
+    array_append(array, &i);
+  }
+  for (var i = 0; i < 100; i += 1) {
+    XCTAssertEqual(*(Int64*)array_at(array, i), i);
+    XCTAssertEqual(*(Int64*)ARRAY_AT(array, i), i);
+    *(Int64*)array_at(array, i) *= 2;
+  }
+  
+  var count = 0ll;
+  Int64* span = array_span(array, &count);
+  XCTAssertEqual(count, 100);
+  var sum = 0ll;
+  for (var i = 0; i < count; i += 1) {
+    sum += span[i];
+  }
+  XCTAssertEqual(sum, 9900);
+  
+  array_deinit(array);
+}
+
+- (void) test_first_index_of_bytes {
+  var array = array_init(sizeof(Int64));
+  
+  for (var i = 0ll; i < 1000; i += 1) {
+    array_append(array, &i);
+  }
+  for (var i = 0ll; i < 1000; i += 37) {
+    XCTAssertEqual(array_first_index_of_bytes(array, &i), i);
+  }
+  var missing = 1000ll;
+  XCTAssertEqual(array_first_index_of_bytes(array, &missing), -1);
+  XCTAssertFalse(array_contains_bytes(array, &missing));
+  /* A value differing only in its high byte must not match. */
+  var shadow = (1ll << 56) | 999;
+  XCTAssertFalse(array_contains_bytes(array, &shadow));
+  array_append(array, &shadow);
+  XCTAssertEqual(array_first_index_of_bytes(array, &shadow), 1000);
+  
+  var triples = array_init(3);
+  char bytes[] = "abcabdabe";
+  array_append_contents(triples, bytes, 3);
+  XCTAssertEqual(array_first_index_of_bytes(triples, "abe"), 2);
+  XCTAssertEqual(array_first_index_of_bytes(triples, "bca"), -1);
+  
+  array_deinit(array);
+  array_deinit(triples);
+}
+
+- (void) test_equal {
+  var a = array_init(sizeof(int));
+  var b = array_init(sizeof(int));
+  XCTAssertTrue(array_equal(a, b));
+  
+  for (var i = 0; i < 100; i += 1) {
+    array_append(a, &i);
+    array_append(b, &i);
+  }
+  XCTAssertTrue(array_equal(a, b));
+  
+  *(int*)array_at(b, 99) = -1;
+  XCTAssertFalse(array_equal(a, b));
+  array_remove_last(b);
+  XCTAssertFalse(array_equal(a, b));
+  
+  array_deinit(a);
+  array_deinit(b);
+}
+  
+- (void) test_snapshot {
+  var array = array_init(sizeof(int));
+  for (var i = 0; i < 1000; i += 1) {
+    array_append(array, &i);
+  }
+  
+  var snapshot = array_snapshot(array);
+  XCTAssertEqual(snapshot->_storage, array->_storage);
+  XCTAssertEqual(snapshot->count, 1000);
+  XCTAssertEqual(*array->_reference_count, 2);
+  
+  /* The first change copies the storage; the snapshot keeps the old values. */
+  var delta = -1;
+  array_set(array, 0, &delta);
+  XCTAssertNotEqual(snapshot->_storage, array->_storage);
+  XCTAssertEqual(array->_reference_count, NULL);
+  XCTAssertEqual(*(int*)array_at(array, 0), -1);
+  XCTAssertEqual(*(int*)array_at(snapshot, 0), 0);
+  
+  var other = array_snapshot(snapshot);
+  array_deinit(snapshot);
+  while (other->count > 10) {
+    array_remove_last(other);
+  }
+  XCTAssertEqual(other->_reference_count, NULL);
+  for (var i = 0; i < 10; i += 1) {
+    XCTAssertEqual(*(int*)array_at(other, i), i);
+  }
+  
+  array_deinit(array);
+  array_deinit(other);
+}
+
+- (void) test_write_read {
+  var array = array_init(sizeof(Int64));
+  for (var i = 0ll; i < 10000; i += 1) {
+    array_append(array, &i);
+  }
+  
+  char path[] = "/tmp/array_tests_XXXXXX";
+  var fd = mkstemp(path);
+  XCTAssertTrue(array_write(array, fd));
+  lseek(fd, 0, SEEK_SET);
+  var read = array_read(fd);
+  XCTAssertNotEqual(read, NULL);
+  XCTAssertTrue(array_equal(array, read));
+  
+  /* A flipped byte fails the checksum. */
+  lseek(fd, ARRAY_FILE_HEADER_SIZE + 8, SEEK_SET);
+  var delta = 0xff;
+  write(fd, &delta, 1);
+  lseek(fd, 0, SEEK_SET);
+  XCTAssertEqual(array_read(fd), NULL);
+  
+  /* A count larger than the file holds is rejected before allocating. */
+  var count = 1ll << 40;
+  lseek(fd, 16, SEEK_SET);
+  write(fd, &count, sizeof(count));
+  lseek(fd, 0, SEEK_SET);
+  errno = 0;
+  XCTAssertEqual(array_read(fd), NULL);
+  XCTAssertEqual(errno, EINVAL);
+  
+  close(fd);
+  unlink(path);
+  array_deinit(array);
+  array_deinit(read);
+}
+
+- (void) test_map_file {
+  var array = array_init(sizeof(Int64));
+  for (var i = 0ll; i < 10000; i += 1) {
+    array_append(array, &i);
+  }
+  char path[] = "/tmp/array_tests_XXXXXX";
+  var fd = mkstemp(path);
+  array_write(array, fd);
+  close(fd);
+  
+  var mapped = array_map_file(path);
+  unlink(path);
+  XCTAssertTrue(mapped->_is_read_only);
+  XCTAssertTrue(array_equal(array, mapped));
+  
+  /* Changing a mapped array copies it out of the file first. */
+  var delta = -1ll;
+  array_append(mapped, &delta);
+  XCTAssertFalse(mapped->_is_read_only);
+  XCTAssertEqual(mapped->count, 10001);
+  array_get(mapped, 9999, &delta);
+  XCTAssertEqual(delta, 9999);
+  
+  array_deinit(array);
+  array_deinit(mapped);
+}
+
+- (void) test_inline_capacity {
+  var array = array_init_with_inline_capacity(sizeof(int), 8);
+  XCTAssertEqual(array->_capacity, 8);
+  XCTAssertNotEqual(array->_storage, NULL);
+  var inline_storage = array->_storage;
+  
+  for (var i = 0; i < 8; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertEqual(array->_storage, inline_storage);
+  
+  for (var i = 8; i < 100; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertNotEqual(array->_storage, inline_storage);
+  XCTAssertEqual(array->_capacity, 128);
+  
+  while (array->count > 3) {
+    array_remove_last(array);
+  }
+  XCTAssertEqual(array->_storage, inline_storage);
+  XCTAssertEqual(array->_capacity, 8);
+  for (var i = 0; i < 3; i += 1) {
+    XCTAssertEqual(*(int*)array_at(array, i), i);
+  }
+  
+  array_remove_all(array);
+  XCTAssertEqual(array->_storage, inline_storage);
+  XCTAssertEqual(array->_capacity, 8);
+  
+  array_deinit(array);
+}
+
+- (void) test_mapping_threshold {
+  var array = array_init(sizeof(Int64));
+  array_set_mapping_threshold(array, 1 << 20, true);
+  
+  for (var i = 0ll; i < 1000000; i += 1) {
+    array_append(array, &i);
+  }
+#ifdef __linux__
+  XCTAssertTrue(array->_is_mapped);
+#endif
+  for (var i = 0; i < 1000000; i += 1) {
+    XCTAssertEqual(*(Int64*)array_at(array, i), i);
+  }
+  
+  while (array->count > 1000) {
+    array_remove_last(array);
+  }
+  XCTAssertFalse(array->_is_mapped);
+  for (var i = 0; i < 1000; i += 1) {
+    XCTAssertEqual(*(Int64*)array_at(array, i), i);
+  }
+  
+  array_deinit(array);
+}
+
+- (void) test_template {
+  var array = int64_array_init();
+  
+  for (var i = 0ll; i < 1000; i += 1) {
+    int64_array_append(array, i);
+  }
+  XCTAssertEqual(array->count, 1000);
+  XCTAssertEqual(array->_capacity, 1024);
+  for (var i = 0; i < 1000; i += 1) {
+    XCTAssertEqual(int64_array_get(array, i), i);
+  }
+  
+  int64_array_set(array, 5, -1);
+  XCTAssertEqual(*int64_array_at(array, 5), -1);
+  
+  Int64 input[] = {7, 8, 9};
+  int64_array_append_contents(array, input, 3);
+  XCTAssertEqual(int64_array_get(array, 1002), 9);
+  
+  while (!array->is_empty) {
+    int64_array_remove_last(array);
+  }
+  XCTAssertEqual(array->_capacity, 0);
+  
+  int64_array_deinit(array);
+}
+
 - (void) test_sort {
   var array = array_init(sizeof(int));
   var result = array_init(sizeof(int));
@@ -105,6 +543,99 @@
   array_deinit(result);
 }
 
+- (void) test_sort_parallel {
+  var count = 4 * SORT_PARALLEL_THRESHOLD + 1935;
+  var array = array_init(sizeof(int));
+  var result = array_init(sizeof(int));
+
+  for (var i = 0; i < count; i += 1) {
+    var delta = arc4random();
+    array_append(array, &delta);
+    array_append(result, &delta);
+  }
+  array_sort_parallel(array, compare, 3);
+  qsort(result->_storage, count, sizeof(int), compare);
+  XCTAssertEqual(
+    0,
+    memcmp(result->_storage, array->_storage, count * sizeof(int))
+  );
+
+  array_deinit(array);
+  array_deinit(result);
+}
+
+- (void) test_radix_sort {
+  var array = array_init(sizeof(Int64));
+  var result = array_init(sizeof(Int64));
+
+  for (var i = 0; i < 19358; i += 1) {
+    Int64 delta = (Int64)arc4random() - (1ll << 31);
+    array_append(array, &delta);
+    array_append(result, &delta);
+  }
+  array_radix_sort(array, 0, SORT_KEY_INT64);
+  qsort(result->_storage, 19358, sizeof(Int64), compare_int64);
+  XCTAssertEqual(
+    0,
+    memcmp(result->_storage, array->_storage, 19358 * sizeof(Int64))
+  );
+
+  array_deinit(array);
+  array_deinit(result);
+}
+
+- (void) test_stable_sort {
+  var array = array_init(sizeof(Int64));
+
+  /* The low 32 bits are the original position, the high ones the key. */
+  for (var i = 0; i < 19358; i += 1) {
+    Int64 element = (Int64)(arc4random() % 100) << 32 | i;
+    array_append(array, &element);
+  }
+  array_stable_sort(array, compare_keys);
+  for (var i = 1; i < 19358; i += 1) {
+    Int64 previous;
+    Int64 element;
+    array_get(array, i - 1, &previous);
+    array_get(array, i, &element);
+    XCTAssertLessThan(previous, element);
+  }
+
+  array_deinit(array);
+}
+
+- (void) test_argsort {
+  /* 128-byte records: a key, then the key repeated as payload. */
+  var array = array_init(16 * sizeof(Int64));
+
+  for (var i = 0; i < 1935; i += 1) {
+    Int64 record[16];
+    for (var j = 0; j < 16; j += 1) {
+      record[j] = (i * 7919) % 1000;
+    }
+    array_append(array, record);
+  }
+  var permutation = array_argsort(array, compare_int64);
+  XCTAssertEqual(permutation->count, 1935);
+  var indices = array_snapshot(permutation);
+
+  array_apply_permutation(array, permutation);
+  XCTAssertTrue(array_equal(permutation, indices));
+  for (var i = 0; i < 1935; i += 1) {
+    Int64* record = array_at(array, i);
+    if (i > 0) {
+      XCTAssertLessThanOrEqual(*(Int64*)array_at(array, i - 1), record[0]);
+    }
+    for (var j = 1; j < 16; j += 1) {
+      XCTAssertEqual(record[j], record[0]);
+    }
+  }
+
+  array_deinit(indices);
+  array_deinit(permutation);
+  array_deinit(array);
+}
+
 - (void) test_sort_string {
   var array = array_init(sizeof(struct String*));
   
@@ -130,6 +661,21 @@
   array_deinit(array);
 }
 
+static Bool is_multiple(const void* element, void* context) {
+  return *(int*)element % *(int*)context == 0;
+}
+
+/* Compares the high 32 bits of two Int64s. */
+static int compare_keys(const void* a, const void* b) {
+  var x = *(Int64*)a >> 32;
+  var y = *(Int64*)b >> 32;
+  return x < y ? -1 : x > y;
+}
+
+static int compare_int64(const void* a, const void* b) {
+  return *(Int64*)a < *(Int64*)b ? -1 : *(Int64*)a > *(Int64*)b;
+}
+
 static int compare(const void* a, const void* b) {
   if (*(int*)a > *(int*)b) {
     return 1;
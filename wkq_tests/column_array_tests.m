@@ -0,0 +1,116 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <stddef.h>
+
+#import "column_array.h"
+
+#define var __auto_type
+
+struct Trade {
+  Int64 time;
+  Double price;
+  Int32 quantity;
+};
+
+@interface ColumnArrayTests : XCTestCase
+
+@end
+
+@implementation ColumnArrayTests
+
+- (void) test_init {
+  UInt32 widths[] = {sizeof(Int64), sizeof(Int8), sizeof(Int32)};
+  var array = column_array_init(3, widths, NULL);
+  
+  XCTAssertEqual(array->count, 0);
+  XCTAssertEqual(array->is_empty, true);
+  XCTAssertEqual(array->_capacity, 0);
+  XCTAssertEqual(array->_column_count, 3);
+  /* Packed rows */
+  XCTAssertEqual(array->_offsets[1], 8);
+  XCTAssertEqual(array->_offsets[2], 9);
+  
+  column_array_deinit(array);
+}
+
+- (void) test_rows {
+  UInt32 widths[] = {sizeof(Int64), sizeof(Double), sizeof(Int32)};
+  UInt32 offsets[] = {
+    offsetof(struct Trade, time),
+    offsetof(struct Trade, price),
+    offsetof(struct Trade, quantity)
+  };
+  var array = column_array_init(3, widths, offsets);
+  
+  for (var i = 0; i < 1000; i += 1) {
+    struct Trade trade = {i, i * 0.25, -i};
+    column_array_append(array, &trade);
+  }
+  XCTAssertEqual(array->count, 1000);
+  XCTAssertEqual(array->_capacity, 1024);
+  
+  for (var i = 0; i < 1000; i += 1) {
+    struct Trade trade;
+    column_array_get(array, i, &trade);
+    XCTAssertEqual(trade.time, i);
+    XCTAssertEqual(trade.price, i * 0.25);
+    XCTAssertEqual(trade.quantity, -i);
+  }
+  
+  struct Trade trade = {-1, -1, -1};
+  column_array_set(array, 500, &trade);
+  XCTAssertEqual(*(Double*)column_array_at(array, 500, 1), -1);
+  
+  while (array->count > 100) {
+    column_array_remove_last(array);
+  }
+  XCTAssertEqual(array->_capacity, 256);
+  column_array_remove_all(array);
+  XCTAssertTrue(array->is_empty);
+  XCTAssertEqual(array->_capacity, 0);
+  
+  column_array_deinit(array);
+}
+
+- (void) test_column {
+  UInt32 widths[] = {sizeof(Int64), sizeof(Double), sizeof(Int32)};
+  UInt32 offsets[] = {
+    offsetof(struct Trade, time),
+    offsetof(struct Trade, price),
+    offsetof(struct Trade, quantity)
+  };
+  var array = column_array_init(3, widths, offsets);
+  column_array_reserve(array, 100);
+  XCTAssertEqual(array->_capacity, 100);
+  
+  for (var i = 0; i < 100; i += 1) {
+    struct Trade trade = {i, 1.5, i % 7};
+    column_array_append(array, &trade);
+  }
+  
+  Int64 count;
+  Int32* quantities = column_array_column(array, 2, &count);
+  XCTAssertEqual(count, 100);
+  var sum = 0;
+  for (var i = 0; i < count; i += 1) {
+    sum += quantities[i];
+  }
+  XCTAssertEqual(sum, 295);
+  
+  Double* prices = column_array_column(array, 1, NULL);
+  XCTAssertEqual(prices[99], 1.5);
+  
+  column_array_deinit(array);
+}
+
+@end
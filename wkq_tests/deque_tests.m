@@ -11,9 +11,12 @@
 #import <XCTest/XCTest.h>
 
 #import "deque.h"
+#import "deque_template.h"
 
 #define var __auto_type
 
+DEQUE_DEFINE(Int64Deque, int64_deque, Int64)
+
 @interface DequeTests : XCTestCase
 
 @end
@@ -81,4 +84,54 @@
   deque_deinit(deque);
 }
 
+- (void) test_remove_first {
+  var deque = deque_init(sizeof(int));
+  
+  for (var i = 0; i < 1000; i += 1) {
+    deque_append(deque, &i);
+  }
+  for (var i = 0; i < 1000; i += 1) {
+    var delta = 0;
+    deque_get(deque, 0, &delta);
+    XCTAssertEqual(delta, i);
+    deque_get(deque, deque->count - 1, &delta);
+    XCTAssertEqual(delta, 999);
+    deque_remove_first(deque);
+  }
+  XCTAssertTrue(deque->is_empty);
+  
+  deque_deinit(deque);
+}
+
+- (void) test_at {
+  var deque = deque_init(sizeof(int));
+  
+  for (var i = 0; i < 100; i += 1) {
+    deque_append(deque, &i);
+  }
+  deque_remove_first(deque); /* Moves half of the elements to the head */
+  for (var i = 0; i < 99; i += 1) {
+    XCTAssertEqual(*(int*)deque_at(deque, i), i + 1);
+    XCTAssertEqual(*(int*)DEQUE_AT(deque, i), i + 1);
+  }
+  
+  deque_deinit(deque);
+}
+
+- (void) test_template {
+  var deque = int64_deque_init();
+  
+  for (var i = 0ll; i < 1000; i += 1) {
+    int64_deque_append(deque, i);
+  }
+  for (var i = 0; i < 1000; i += 1) {
+    XCTAssertEqual(int64_deque_get(deque, 0), i);
+    XCTAssertEqual(*int64_deque_at(deque, deque->count - 1), 999);
+    int64_deque_remove_first(deque);
+  }
+  XCTAssertTrue(deque->is_empty);
+  
+  int64_deque_deinit(deque);
+}
+
 @end
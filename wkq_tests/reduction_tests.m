@@ -0,0 +1,148 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "array.h"
+#import "reduction.h"
+
+#define var __auto_type
+
+@interface ReductionTests : XCTestCase
+
+@end
+
+@implementation ReductionTests
+
+- (void) test_sum {
+  var int32s = array_init(sizeof(Int32));
+  var int64s = array_init(sizeof(Int64));
+  var doubles = array_init(sizeof(Double));
+  XCTAssertEqual(array_sum_int64(int64s), 0);
+  
+  for (var i = 0; i < 1001; i += 1) {
+    Int32 a = i % 2 == 0 ? INT32_MAX : -i;
+    Int64 b = i;
+    Double c = i * 0.5;
+    array_append(int32s, &a);
+    array_append(int64s, &b);
+    array_append(doubles, &c);
+  }
+  XCTAssertEqual(array_sum_int32(int32s), 501ll * INT32_MAX - 250000);
+  XCTAssertEqual(array_sum_int64(int64s), 500500);
+  XCTAssertEqual(array_sum_double(doubles), 250250.0);
+  
+  array_deinit(int32s);
+  array_deinit(int64s);
+  array_deinit(doubles);
+}
+
+- (void) test_sum_parallel {
+  var array = array_init(sizeof(Int64));
+  
+  var count = REDUCTION_PARALLEL_THRESHOLD * 4 + 3;
+  for (var i = 0ll; i < count; i += 1) {
+    array_append(array, &i);
+  }
+  XCTAssertEqual(array_sum_int64_parallel(array, 0), count * (count - 1) / 2);
+  XCTAssertEqual(array_sum_int64_parallel(array, 3), count * (count - 1) / 2);
+  XCTAssertEqual(array_sum_int64_parallel(array, 1), array_sum_int64(array));
+  
+  array_deinit(array);
+}
+
+- (void) test_min_max {
+  var array = array_init(sizeof(Double));
+  
+  for (var i = 0; i < 999; i += 1) {
+    Double delta = (i * 7919) % 1000 - 500.5;
+    array_append(array, &delta);
+  }
+  Double min = 0;
+  Double max = 0;
+  array_min_max_double(array, &min, &max);
+  XCTAssertEqual(min, -500.5);
+  XCTAssertEqual(max, 498.5);
+  XCTAssertEqual(*(Double*)array_at(array, array_argmin_double(array)), min);
+  XCTAssertEqual(*(Double*)array_at(array, array_argmax_double(array)), max);
+  
+  array_deinit(array);
+}
+
+- (void) test_argmin_argmax {
+  var array = array_init(sizeof(Int64));
+  
+  for (var i = 0ll; i < 100; i += 1) {
+    var delta = i % 10;
+    array_append(array, &delta);
+  }
+  /* Ties go to the first index. */
+  XCTAssertEqual(array_argmin_int64(array), 0);
+  XCTAssertEqual(array_argmax_int64(array), 9);
+  
+  var delta = -1ll;
+  array_set(array, 57, &delta);
+  array_set(array, 93, &delta);
+  XCTAssertEqual(array_argmin_int64(array), 57);
+  
+  var int32s = array_init(sizeof(Int32));
+  for (var i = 0; i < 101; i += 1) {
+    var element = i % 10;
+    array_append(int32s, &element);
+  }
+  XCTAssertEqual(array_argmin_int32(int32s), 0);
+  XCTAssertEqual(array_argmax_int32(int32s), 9);
+  var element = 10;
+  array_set(int32s, 99, &element);
+  array_set(int32s, 100, &element);
+  XCTAssertEqual(array_argmax_int32(int32s), 99);
+  
+  array_deinit(array);
+  array_deinit(int32s);
+}
+
+- (void) test_prefix_sum {
+  var array = array_init(sizeof(Int64));
+  
+  for (var i = 1ll; i <= 10; i += 1) {
+    array_append(array, &i);
+  }
+  array_inclusive_prefix_sum_int64(array);
+  for (var i = 0; i < 10; i += 1) {
+    XCTAssertEqual(*(Int64*)array_at(array, i), (i + 1) * (i + 2) / 2);
+  }
+  
+  var doubles = array_init(sizeof(Double));
+  for (var i = 0; i < 7; i += 1) {
+    var delta = 1.5;
+    array_append(doubles, &delta);
+  }
+  array_exclusive_prefix_sum_double(doubles);
+  for (var i = 0; i < 7; i += 1) {
+    XCTAssertEqual(*(Double*)array_at(doubles, i), i * 1.5);
+  }
+  
+  var int32s = array_init(sizeof(Int32));
+  for (var i = 0; i < 9; i += 1) {
+    array_append(int32s, &i);
+  }
+  array_exclusive_prefix_sum_int32(int32s);
+  for (var i = 0; i < 9; i += 1) {
+    XCTAssertEqual(*(Int32*)array_at(int32s, i), i * (i - 1) / 2);
+  }
+  array_inclusive_prefix_sum_int32(int32s);
+  XCTAssertEqual(*(Int32*)array_at(int32s, 8), 84);
+  
+  array_deinit(array);
+  array_deinit(doubles);
+  array_deinit(int32s);
+}
+
+@end
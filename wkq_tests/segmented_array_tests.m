@@ -0,0 +1,127 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "segmented_array.h"
+
+#define var __auto_type
+
+@interface SegmentedArrayTests : XCTestCase
+
+@end
+
+@implementation SegmentedArrayTests
+
+- (void) test_init {
+  var array = segmented_array_init(sizeof(int));
+  
+  XCTAssertEqual(array->count, 0);
+  XCTAssertEqual(array->_width, sizeof(int));
+  XCTAssertEqual(array->is_empty, true);
+  XCTAssertEqual(array->_capacity, 0);
+  XCTAssertEqual(array->_block_count, 0);
+  
+  segmented_array_deinit(array);
+}
+
+- (void) test_append {
+  var array = segmented_array_init(sizeof(Int64));
+  
+  for (var i = 0ll; i < 10000; i += 1) {
+    segmented_array_append(array, &i);
+  }
+  XCTAssertEqual(array->count, 10000);
+  XCTAssertFalse(array->is_empty);
+  XCTAssertEqual(array->_capacity, 16368);
+  
+  for (var i = 0ll; i < 10000; i += 1) {
+    var delta = 0ll;
+    segmented_array_get(array, i, &delta);
+    XCTAssertEqual(delta, i);
+    delta *= 2;
+    segmented_array_set(array, i, &delta);
+    XCTAssertEqual(*(Int64*)segmented_array_at(array, i), i * 2);
+  }
+  
+  segmented_array_deinit(array);
+}
+
+- (void) test_stable_addresses {
+  var array = segmented_array_init(sizeof(int));
+  
+  var delta = 0;
+  segmented_array_append(array, &delta);
+  int* first = segmented_array_at(array, 0);
+  for (delta = 1; delta < 1000; delta += 1) {
+    segmented_array_append(array, &delta);
+  }
+  XCTAssertEqual(segmented_array_at(array, 0), first);
+  XCTAssertEqual(*first, 0);
+  
+  segmented_array_deinit(array);
+}
+
+- (void) test_segment_at {
+  var array = segmented_array_init(sizeof(Int64));
+  
+  for (var i = 0ll; i < 100; i += 1) {
+    segmented_array_append(array, &i);
+  }
+  var i = 0ll;
+  var segment_count = 0;
+  while (i < array->count) {
+    Int64 count;
+    Int64* segment = segmented_array_segment_at(array, i, &count);
+    for (var j = 0; j < count; j += 1) {
+      XCTAssertEqual(segment[j], i + j);
+    }
+    i += count;
+    segment_count += 1;
+  }
+  /* 16 + 32 + 52 */
+  XCTAssertEqual(segment_count, 3);
+  
+  Int64 count;
+  segmented_array_segment_at(array, 20, &count);
+  XCTAssertEqual(count, 28);
+  
+  segmented_array_deinit(array);
+}
+
+- (void) test_remove {
+  var array = segmented_array_init(sizeof(int));
+  
+  for (var i = 0; i < 1000; i += 1) {
+    segmented_array_append(array, &i);
+  }
+  XCTAssertEqual(array->_block_count, 6);
+  while (array->count > 20) {
+    segmented_array_remove_last(array);
+  }
+  /* Blocks 0 and 1 hold the elements, block 2 is kept as a spare. */
+  XCTAssertEqual(array->_block_count, 3);
+  XCTAssertEqual(*(int*)segmented_array_at(array, 19), 19);
+  
+  while (!array->is_empty) {
+    segmented_array_remove_last(array);
+  }
+  XCTAssertEqual(array->_block_count, 1);
+  
+  segmented_array_reserve(array, 100);
+  XCTAssertEqual(array->_capacity, 112);
+  segmented_array_remove_all(array);
+  XCTAssertEqual(array->_capacity, 0);
+  XCTAssertTrue(array->is_empty);
+  
+  segmented_array_deinit(array);
+}
+
+@end
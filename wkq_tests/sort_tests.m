@@ -0,0 +1,451 @@
+/*
+ * This source file is part of the C Collections open source project
+ *
+ * Copyright (c) 2024 Fang Ling
+ * Licensed under Apache License v2.0
+ *
+ * See https://github.com/fang-ling/C-Collections/blob/main/LICENSE for license
+ * information
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <math.h>
+
+#import "sort.h"
+#import "sort_template.h"
+#import "types.h"
+
+#define var __auto_type
+
+struct Pair {
+  Int32 key;
+  Int32 value;
+};
+
+#define PAIR_KEY_LESS(a, b) ((a).key < (b).key)
+
+SORT_DEFINE(sort_int64, Int64, SORT_LESS)
+SORT_DEFINE(sort_pairs, struct Pair, PAIR_KEY_LESS)
+
+/* A record whose key is its first 8 bytes, padded to `width` bytes. */
+static void make_records(void* base, Int64 count, size_t width, Int64 seed) {
+  memset(base, 0, count * width);
+  for (var i = 0ll; i < count; i += 1) {
+    var key = (i * 7919 + seed) % (count / 2 + 1);
+    memcpy(base + i * width, &key, sizeof(Int64));
+    /* The payload follows the key, so swapped bytes would be noticed. */
+    memset(base + i * width + sizeof(Int64), (int)key, width - sizeof(Int64));
+  }
+}
+
+static Bool is_sorted_records(void* base, Int64 count, size_t width) {
+  for (var i = 0ll; i < count; i += 1) {
+    Int64 key;
+    memcpy(&key, base + i * width, sizeof(Int64));
+    for (var b = sizeof(Int64); b < width; b += 1) {
+      if (((UInt8*)base)[i * width + b] != (UInt8)key) {
+        return false;
+      }
+    }
+    if (i > 0) {
+      Int64 previous;
+      memcpy(&previous, base + (i - 1) * width, sizeof(Int64));
+      if (previous > key) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static int compare_keys(const void* a, const void* b) {
+  Int64 x;
+  Int64 y;
+  memcpy(&x, a, sizeof(Int64));
+  memcpy(&y, b, sizeof(Int64));
+  return x < y ? -1 : x > y;
+}
+
+static int compare_ints(const void* a, const void* b) {
+  return *(int*)a < *(int*)b ? -1 : *(int*)a > *(int*)b;
+}
+
+static Int64 comparison_count = 0;
+
+static int counting_compare_ints(const void* a, const void* b) {
+  comparison_count += 1;
+  return compare_ints(a, b);
+}
+
+@interface SortTests : XCTestCase
+
+@end
+
+@implementation SortTests
+
+- (void) test_sort {
+  int array[] = {19358, 19342, 20, 7, 3, 2, -1};
+  sort(array, 7, sizeof(int), compare_ints);
+  
+  int result[] = {-1, 2, 3, 7, 20, 19342, 19358};
+  for (var i = 0; i < 7; i += 1) {
+    XCTAssertEqual(array[i], result[i]);
+  }
+}
+
+- (void) test_widths {
+  size_t widths[] = {8, 16, 24, 64, 100, 300};
+  Int64 counts[] = {0, 1, 2, 50, 1000};
+  for (var w = 0; w < 6; w += 1) {
+    for (var c = 0; c < 5; c += 1) {
+      var width = widths[w];
+      var count = counts[c];
+      void* base = malloc(count * width + 1);
+      make_records(base, count, width, w + c);
+      sort(base, count, width, compare_keys);
+      XCTAssertTrue(is_sorted_records(base, count, width));
+      free(base);
+    }
+  }
+}
+
+- (void) test_sorted_and_reversed {
+  int array[1000];
+  for (var i = 0; i < 1000; i += 1) {
+    array[i] = 1000 - i;
+  }
+  sort(array, 1000, sizeof(int), compare_ints);
+  for (var i = 0; i < 1000; i += 1) {
+    XCTAssertEqual(array[i], i + 1);
+  }
+  sort(array, 1000, sizeof(int), compare_ints);
+  for (var i = 0; i < 1000; i += 1) {
+    XCTAssertEqual(array[i], i + 1);
+  }
+}
+
+- (void) test_duplicates {
+  var count = 100000;
+  int* array = malloc(count * sizeof(int));
+  for (var i = 0; i < count; i += 1) {
+    array[i] = (i * 7919) % 3;
+  }
+  comparison_count = 0;
+  sort(array, count, sizeof(int), counting_compare_ints);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(array[i - 1], array[i]);
+  }
+  /* Three distinct keys: a few linear passes, not n^2 / 2. */
+  XCTAssertLessThan(comparison_count, 20ll * count);
+  
+  free(array);
+}
+
+- (void) test_reversed_with_duplicates {
+  int array[1000];
+  var count = 1000ll;
+  for (var i = 0; i < count; i += 1) {
+    array[i] = (int)(count - i) / 2;
+  }
+  comparison_count = 0;
+  sort(array, count, sizeof(int), counting_compare_ints);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(array[i - 1], array[i]);
+  }
+  /* Recognized in one pass and reversed, not partitioned. */
+  XCTAssertLessThanOrEqual(comparison_count, 2 * count);
+}
+
+- (void) test_reproducible {
+  /* Pairs with equal keys (the first int) land in the same order each time. */
+  var count = 5000;
+  int* first = malloc(2 * count * sizeof(int));
+  int* second = malloc(2 * count * sizeof(int));
+  for (var i = 0; i < count; i += 1) {
+    first[2 * i] = (i * 7919) % 10;
+    first[2 * i + 1] = i;
+  }
+  memcpy(second, first, 2 * count * sizeof(int));
+  sort(first, count, 2 * sizeof(int), compare_ints);
+  sort(second, count, 2 * sizeof(int), compare_ints);
+  XCTAssertEqual(memcmp(first, second, 2 * count * sizeof(int)), 0);
+  
+  free(first);
+  free(second);
+}
+
+- (void) test_sort_parallel {
+  /* Odd and even run counts, and an unpaired run in some merge rounds. */
+  var count = 5 * SORT_PARALLEL_THRESHOLD + 7;
+  int* array = malloc(count * sizeof(int));
+  int* expected = malloc(count * sizeof(int));
+  for (var threads = 0ll; threads <= 8; threads += 1) {
+    for (var i = 0ll; i < count; i += 1) {
+      array[i] = (int)((i * 7919) % (count / 3));
+    }
+    memcpy(expected, array, count * sizeof(int));
+    sort(expected, count, sizeof(int), compare_ints);
+    sort_parallel(array, count, sizeof(int), compare_ints, threads);
+    XCTAssertEqual(memcmp(array, expected, count * sizeof(int)), 0);
+  }
+  
+  /* Below the threshold it is just sort(). */
+  for (var i = 0; i < 100; i += 1) {
+    array[i] = 99 - i;
+  }
+  sort_parallel(array, 100, sizeof(int), compare_ints, 8);
+  for (var i = 0; i < 100; i += 1) {
+    XCTAssertEqual(array[i], i);
+  }
+  
+  free(array);
+  free(expected);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  return *(Double*)a < *(Double*)b ? -1 : *(Double*)a > *(Double*)b;
+}
+
+- (void) test_radix_sort_integers {
+  var count = 10000;
+  Int32 int32s[count];
+  UInt32 uint32s[count];
+  Int64 int64s[count];
+  UInt64 uint64s[count];
+  for (var i = 0; i < count; i += 1) {
+    int32s[i] = (Int32)arc4random();
+    uint32s[i] = arc4random();
+    int64s[i] = (Int64)((UInt64)arc4random() << 32 | arc4random());
+    uint64s[i] = (UInt64)arc4random() << 32 | arc4random();
+  }
+  radix_sort(int32s, count, sizeof(Int32), 0, SORT_KEY_INT32);
+  radix_sort(uint32s, count, sizeof(UInt32), 0, SORT_KEY_UINT32);
+  radix_sort(int64s, count, sizeof(Int64), 0, SORT_KEY_INT64);
+  radix_sort(uint64s, count, sizeof(UInt64), 0, SORT_KEY_UINT64);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(int32s[i - 1], int32s[i]);
+    XCTAssertLessThanOrEqual(uint32s[i - 1], uint32s[i]);
+    XCTAssertLessThanOrEqual(int64s[i - 1], int64s[i]);
+    XCTAssertLessThanOrEqual(uint64s[i - 1], uint64s[i]);
+  }
+}
+
+- (void) test_radix_sort_doubles {
+  Double values[] = {
+    3.5, -0.0, 1e300, -INFINITY, 0.0, -2.25, INFINITY, -1e-300, 1e-300, -7.0
+  };
+  var count = sizeof(values) / sizeof(values[0]);
+  Double expected[count];
+  memcpy(expected, values, sizeof(values));
+  sort(expected, count, sizeof(Double), compare_doubles);
+  radix_sort(values, count, sizeof(Double), 0, SORT_KEY_DOUBLE);
+  for (var i = 0; i < count; i += 1) {
+    XCTAssertEqual(values[i], expected[i]);
+  }
+  /* -0.0 comes before +0.0. */
+  XCTAssertTrue(signbit(values[4]));
+  XCTAssertFalse(signbit(values[5]));
+}
+
+- (void) test_radix_sort_records {
+  /* The key is the second int; the first one records the original order. */
+  var count = 5000;
+  int* pairs = malloc(2 * count * sizeof(int));
+  for (var i = 0; i < count; i += 1) {
+    pairs[2 * i] = i;
+    pairs[2 * i + 1] = (i * 7919) % 100 - 50;
+  }
+  radix_sort(pairs, count, 2 * sizeof(int), sizeof(int), SORT_KEY_INT32);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(pairs[2 * i - 1], pairs[2 * i + 1]);
+    if (pairs[2 * i - 1] == pairs[2 * i + 1]) {
+      /* Stable: equal keys keep their order. */
+      XCTAssertLessThan(pairs[2 * i - 2], pairs[2 * i]);
+    }
+  }
+  
+  free(pairs);
+}
+
+static int compare_first_ints(const void* a, const void* b) {
+  comparison_count += 1;
+  return *(int*)a < *(int*)b ? -1 : *(int*)a > *(int*)b;
+}
+
+/* Checks that pairs are sorted by key, and by original position (second). */
+static Bool is_stably_sorted_pairs(int* pairs, Int64 count) {
+  for (var i = 1ll; i < count; i += 1) {
+    if (
+      pairs[2 * i - 2] > pairs[2 * i] ||
+      (pairs[2 * i - 2] == pairs[2 * i] && pairs[2 * i - 1] > pairs[2 * i + 1])
+    ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+- (void) test_stable_sort {
+  var count = 20000;
+  int* pairs = malloc(2 * count * sizeof(int));
+  UInt8 scratch[1024];
+  
+  /* Few distinct keys, so most elements tie with many others. */
+  for (var i = 0; i < count; i += 1) {
+    pairs[2 * i] = (int)(arc4random() % 10);
+    pairs[2 * i + 1] = i;
+  }
+  stable_sort(pairs, count, 2 * sizeof(int), compare_first_ints, NULL, 0);
+  XCTAssertTrue(is_stably_sorted_pairs(pairs, count));
+  
+  /* Many distinct keys, with a scratch buffer too small for every merge. */
+  for (var i = 0; i < count; i += 1) {
+    pairs[2 * i] = (int)(arc4random() % count);
+    pairs[2 * i + 1] = i;
+  }
+  stable_sort(
+    pairs,
+    count,
+    2 * sizeof(int),
+    compare_first_ints,
+    scratch,
+    sizeof(scratch)
+  );
+  XCTAssertTrue(is_stably_sorted_pairs(pairs, count));
+  
+  free(pairs);
+}
+
+- (void) test_stable_sort_adaptive {
+  var count = 100000;
+  int* array = malloc(count * sizeof(int));
+  
+  /* Two interleaving sorted halves merge by galloping. */
+  for (var i = 0; i < count; i += 1) {
+    array[i] = i < count / 2 ? i : i - count / 4;
+  }
+  comparison_count = 0;
+  stable_sort(array, count, sizeof(int), compare_first_ints, NULL, 0);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(array[i - 1], array[i]);
+  }
+  XCTAssertLessThan(comparison_count, 2ll * count);
+  
+  /* Sorted with a few elements out of place. */
+  for (var i = 0; i < count; i += 1) {
+    array[i] = i;
+  }
+  for (var i = 0; i < 10; i += 1) {
+    array[arc4random() % count] = (int)(arc4random() % count);
+  }
+  comparison_count = 0;
+  stable_sort(array, count, sizeof(int), compare_first_ints, NULL, 0);
+  for (var i = 1; i < count; i += 1) {
+    XCTAssertLessThanOrEqual(array[i - 1], array[i]);
+  }
+  XCTAssertLessThan(comparison_count, 3ll * count);
+  
+  free(array);
+}
+
+- (void) test_sort_indices {
+  var count = 10000;
+  var width = 128;
+  var records = malloc(count * width);
+  make_records(records, count, width, 42);
+  Int64* indices = malloc(count * sizeof(Int64));
+  Int32* indices_int32 = malloc(count * sizeof(Int32));
+  
+  sort_indices(records, count, width, compare_keys, indices);
+  sort_indices_int32(records, count, width, compare_keys, indices_int32);
+  for (var i = 0; i < count; i += 1) {
+    XCTAssertEqual(indices[i], indices_int32[i]);
+  }
+  for (var i = 1; i < count; i += 1) {
+    var order = compare_keys(
+      records + indices[i - 1] * width,
+      records + indices[i] * width
+    );
+    XCTAssertLessThanOrEqual(order, 0);
+    if (order == 0) {
+      /* Stable: equal keys keep their order. */
+      XCTAssertLessThan(indices[i - 1], indices[i]);
+    }
+  }
+  /* The records themselves don't move. */
+  var expected = malloc(count * width);
+  make_records(expected, count, width, 42);
+  XCTAssertEqual(memcmp(records, expected, count * width), 0);
+  
+  free(records);
+  free(expected);
+  free(indices);
+  free(indices_int32);
+}
+
+- (void) test_template {
+  var count = 100000;
+  Int64* array = malloc(count * sizeof(Int64));
+  Int64* expected = malloc(count * sizeof(Int64));
+  for (var round = 0; round < 4; round += 1) {
+    for (var i = 0; i < count; i += 1) {
+      switch (round) {
+        case 0:
+          array[i] = (Int64)arc4random() - (1ll << 31);
+          break;
+        case 1:
+          array[i] = arc4random() % 3;
+          break;
+        case 2:
+          array[i] = i;
+          break;
+        default:
+          array[i] = count - i;
+      }
+    }
+    memcpy(expected, array, count * sizeof(Int64));
+    sort(expected, count, sizeof(Int64), compare_keys);
+    sort_int64(array, count);
+    XCTAssertEqual(memcmp(array, expected, count * sizeof(Int64)), 0);
+  }
+  
+  for (var i = 0; i < count; i += 1) {
+    array[i] = 2 * i;
+  }
+  XCTAssertEqual(sort_int64_lower_bound(array, count, -1), 0);
+  XCTAssertEqual(sort_int64_lower_bound(array, count, 1934), 967);
+  XCTAssertEqual(sort_int64_lower_bound(array, count, 1935), 968);
+  XCTAssertEqual(sort_int64_lower_bound(array, count, 2 * count), count);
+  XCTAssertTrue(sort_int64_binary_search(array, count, 1934));
+  XCTAssertFalse(sort_int64_binary_search(array, count, 1935));
+  XCTAssertFalse(sort_int64_binary_search(array, 0, 0));
+  
+  free(array);
+  free(expected);
+}
+
+- (void) test_template_records {
+  var count = 5000;
+  struct Pair* pairs = malloc(count * sizeof(struct Pair));
+  for (var i = 0; i < count; i += 1) {
+    pairs[i].key = (i * 7919) % 100;
+    pairs[i].value = pairs[i].key * 3;
+  }
+  sort_pairs(pairs, count);
+  for (var i = 0; i < count; i += 1) {
+    if (i > 0) {
+      XCTAssertLessThanOrEqual(pairs[i - 1].key, pairs[i].key);
+    }
+    XCTAssertEqual(pairs[i].value, pairs[i].key * 3);
+  }
+  struct Pair key = {42, 0};
+  var i = sort_pairs_lower_bound(pairs, count, key);
+  XCTAssertEqual(pairs[i].key, 42);
+  XCTAssertEqual(pairs[i - 1].key, 41);
+  XCTAssertTrue(sort_pairs_binary_search(pairs, count, key));
+  
+  free(pairs);
+}
+
+@end